@@ -1,8 +1,13 @@
 #ifndef EXTERNS_HPP
 #define EXTERNS_HPP
 
+#include "lib/ControllerArbiter.hpp"
+#include "lib/ControllerScreen.hpp"
+#include "lib/ControllerState.hpp"
 #include "lib/FourBar.hpp"
+#include "lib/InputRecorder.hpp"
 #include "lib/PneumaticClaw.hpp"
+#include "lib/Scheduler.hpp"
 #include "lib/TankDrive.hpp"
 #include "lib/autonomous.hpp"
 
@@ -17,6 +22,28 @@ extern TankDrive drive;
 // The claw
 extern PneumaticClaw claw;
 
+// Queues driver feedback for the master controller's screen
+extern ControllerScreen masterScreen;
+
+// Runs the background work of every subsystem
+extern Scheduler scheduler;
+
+// Records driver inputs to the SD card, and plays them back
+extern InputRecorder recorder;
+
+// Samples the master and partner controllers for driver control
+extern ControllerArbiter controllers;
+
+// Runs one tick of every subsystem's driver control, each with the input it
+// is mapped to. Shared by opcontrol and the replay autonomous, so replayed
+// inputs go through the same code
+void driverControl(ControllerArbiter& inputs);
+
+// Prints driver control telemetry (input latency and opcontrol loop timing)
+// every 10 seconds in practice. Runs in its own low priority task, so printing
+// never delays the opcontrol loop
+void telemetry();
+
 // Creating a Auton variable to track which autonomous routine to run
 extern Autonomous::Routine autonID;
 
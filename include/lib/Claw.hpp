@@ -1,8 +1,14 @@
 #ifndef CLAW_HPP
 #define CLAW_HPP
 
+#include <atomic>
 #include <initializer_list>
+#include <memory>
 
+#include "lib/Completion.hpp"
+#include "lib/ControllerState.hpp"
+#include "lib/LatencyHistogram.hpp"
+#include "lib/Mechanism.hpp"
 #include "lib/MotorGroup.hpp"
 
 /**
@@ -11,7 +17,14 @@
  * The claw class is used to represent any sort of claw or grabbing device.
  * It encapsulates my MotorGroup class with various functions.
  */
-class Claw {
+/**
+ * The non-blocking commands the claw can be running: none, a relative movement
+ * (openToAsync/closeToAsync), or closing until gripping an object
+ * (closeUntilGrippedAsync).
+ */
+enum class ClawCommand { none, move, grip };
+
+class Claw : public Mechanism {
    private:
     // The MotorGroup representing all motors controlling the claw
     MotorGroup motors;
@@ -33,6 +46,102 @@ class Claw {
      */
     double digitalRotation = 90;
 
+    /**
+     * Homing settings. Homing drives the claw open at homingSpeed RPM until
+     * the motors stall against the hard stop (drawing over homingCurrent mA
+     * while moving under 5 RPM), then zeroes the motor encoders. Homing gives
+     * up after homingTimeout milliseconds.
+     */
+    int homingSpeed = 20;
+    double homingCurrent = 1000;
+    std::uint32_t homingTimeout = 2000;
+
+    /**
+     * Whether homing is in progress, and whether it has succeeded. Set by the
+     * homing task and read by the others. Position commands are refused (or,
+     * if blocking, wait) while homing, as the encoders are about to be zeroed
+     */
+    std::atomic<bool> homing{false};
+    std::atomic<bool> homed{false};
+
+    /**
+     * Grip settings for closeUntilGripped. Contact with an object is detected
+     * when the motors draw more than contactCurrent mA, or when their speed
+     * collapses to under 30% of the peak speed reached while closing. Once in
+     * contact, the motors keep squeezing with their current limited to
+     * gripCurrent mA. If no contact is found within gripTimeout milliseconds,
+     * the claw gives up.
+     */
+    double contactCurrent = 1500;
+    int gripCurrent = 1000;
+    std::uint32_t gripTimeout = 1000;
+
+    // Whether the claw is currently squeezing an object at gripCurrent. Set by
+    // periodic and cleared by the driver and open/close, from other tasks
+    std::atomic<bool> gripping{false};
+
+    // The time from each controller snapshot to the motor write it caused
+    LatencyHistogram inputLatency;
+
+    /**
+     * Non-blocking command state. periodic checks on the current command every
+     * 5 ms and finishes its Completion once it is done.
+     * commandTarget is the target position of a movement (in degrees), and
+     * peakVelocity is the fastest the claw has closed during a grip (in RPM).
+     * commandMutex keeps the state consistent between periodic and the
+     * functions that start commands.
+     */
+    ClawCommand command = ClawCommand::none;
+    double commandTarget = 0;
+    double peakVelocity = 0;
+    std::uint32_t commandStart = 0;
+    std::shared_ptr<Completion> commandCompletion;
+    pros::Mutex commandMutex;
+
+    /**
+     * Function: startCommand
+     * Starts a new non-blocking command, replacing (and failing) any command
+     * already running. Starts periodic calls if needed. Must be called with
+     * commandMutex taken.
+     *
+     * @param newCommand The command to start
+     * @return The Completion handle for the new command
+     */
+    std::shared_ptr<Completion> startCommand(ClawCommand newCommand);
+
+    /**
+     * Function: refusedCommand
+     * @return A Completion that has already failed, for commands refused while
+     * homing
+     */
+    std::shared_ptr<Completion> refusedCommand();
+
+    /**
+     * Function: waitForHoming
+     * Blocks until homing (if in progress) is done
+     */
+    void waitForHoming();
+
+    /**
+     * Function: cancelCommand
+     * Fails and clears the current command (if any), so that manual control can
+     * take over
+     */
+    void cancelCommand();
+
+    /**
+     * Function: updateCommand
+     * Checks whether the current command has finished. Called by periodic.
+     */
+    void updateCommand();
+
+    /**
+     * Function: releaseGrip
+     * Ends a grip from closeUntilGripped, restoring the full current limit.
+     * Called before any other movement.
+     */
+    void releaseGrip();
+
    public:
     /**
      * The constructor for the Claw class
@@ -43,6 +152,13 @@ class Claw {
      */
     Claw(std::initializer_list<int> ports, std::initializer_list<bool> revs);
 
+    /**
+     * Function: periodic
+     * Checks on the current non-blocking command. Called every 5 ms by a
+     * Scheduler, or by the claw's own task once a command has been started
+     */
+    void periodic() override;
+
     /*-------------------------
      * Configuration functions
      *-------------------------*/
@@ -76,6 +192,30 @@ class Claw {
      */
     void setDigitalRotation(double degrees);
 
+    /**
+     * Function: setHoming
+     * This function configures homing, which finds the claw's zero position by
+     * driving it open into its hard stop
+     *
+     * @param speed The speed to open at while homing, in RPM
+     * @param current The current draw, in mA, that indicates the claw has
+     * reached the hard stop (along with the motors barely moving)
+     * @param timeout How long to try homing before giving up, in milliseconds
+     */
+    void setHoming(int speed, double current, std::uint32_t timeout);
+
+    /**
+     * Function: setGrip
+     * This function configures closeUntilGripped
+     *
+     * @param contact The current draw, in mA, that indicates the claw has
+     * closed on an object
+     * @param grip The current, in mA, to hold the object with
+     * @param timeout How long to keep closing without finding an object, in
+     * milliseconds
+     */
+    void setGrip(double contact, int grip, std::uint32_t timeout);
+
     /**------------------
      * Movement Functions
      *-------------------*/
@@ -85,11 +225,11 @@ class Claw {
      * This implementation simply calls either open() or close() if the related
      * buttons are pressed, and sets the velocity of the motors to 0 otherwise
      *
-     * @param controller The controller ID representing the physical controller
+     * @param controller The snapshot of the controller for this tick
      * @param openButton The button on the controller used to open the claw
      * @param closeButton The button on the controller used to close the claw
      */
-    void driver(pros::controller_id_e_t controller,
+    void driver(ControllerState& controller,
                 pros::controller_digital_e_t closeButton,
                 pros::controller_digital_e_t openButton);
 
@@ -98,9 +238,10 @@ class Claw {
      * This implementation of the driver function builds on the previous one
      * by adding digital claw control, which is when a single button is pressed
      * once to open/close the claw. In contrast, analog claw control involves
-     * having to hold a button to keep the claw moving
+     * having to hold a button to keep the claw moving. Digital movements are
+     * non-blocking, so they don't delay the rest of the opcontrol loop.
      *
-     * @param controller The controller ID representing the physical controller
+     * @param controller The snapshot of the controller for this tick
      * @param openButton The button on the controller used to open the claw
      * manually (must be held down)
      * @param closeButton The button on the controller used to close the claw
@@ -110,7 +251,7 @@ class Claw {
      * @param digitalCloseButton The button on the controller used to close the
      * claw digitally (single press)
      */
-    void driver(pros::controller_id_e_t controller,
+    void driver(ControllerState& controller,
                 pros::controller_digital_e_t closeButton,
                 pros::controller_digital_e_t openButton,
                 pros::controller_digital_e_t digitalCloseButton,
@@ -132,7 +273,8 @@ class Claw {
 
     /**
      * Function: openTo
-     * Rotates the claw open by a given degree amount.
+     * Rotates the claw open by a given degree amount. Blocks until the claw
+     * gets there (or is blocked for a second), after waiting for homing.
      *
      * @param degrees The amount of degrees to rotate the claw open by
      */
@@ -140,7 +282,8 @@ class Claw {
 
     /**
      * Function: closeTo
-     * Rotates the claw closed by a given degree amount.
+     * Rotates the claw closed by a given degree amount. Blocks until the claw
+     * gets there (or is blocked for a second), after waiting for homing.
      *
      * @param degrees The amount of degrees to rotate the claw closed by
      */
@@ -159,6 +302,106 @@ class Claw {
      * digital control)
      */
     void closeTo();
+
+    /**
+     * Function: closeUntilGripped
+     * Closes the claw at full speed until it makes contact with an object,
+     * detected from a rise in current draw or a collapse in speed, then keeps
+     * squeezing it at the configured grip current. Blocks until contact is
+     * made or the grip times out, after waiting for homing.
+     *
+     * @return Whether the claw gripped an object
+     */
+    bool closeUntilGripped();
+
+    /**
+     * Function: openToAsync
+     * Starts rotating the claw open by a given degree amount, and returns
+     * immediately.
+     *
+     * @param degrees The amount of degrees to rotate the claw open by
+     * @return A handle that completes (successfully) once the claw gets there,
+     * or unsuccessfully if it is blocked for a second, replaced by another
+     * command or refused because the claw is homing
+     */
+    std::shared_ptr<Completion> openToAsync(double degrees);
+
+    /**
+     * Function: closeToAsync
+     * Starts rotating the claw closed by a given degree amount, and returns
+     * immediately.
+     *
+     * @param degrees The amount of degrees to rotate the claw closed by
+     * @return A handle that completes (successfully) once the claw gets there,
+     * or unsuccessfully if it is blocked for a second, replaced by another
+     * command or refused because the claw is homing
+     */
+    std::shared_ptr<Completion> closeToAsync(double degrees);
+
+    /**
+     * Functions: openToAsync, closeToAsync
+     * Call openToAsync/closeToAsync with digitalRotation
+     */
+    std::shared_ptr<Completion> openToAsync();
+    std::shared_ptr<Completion> closeToAsync();
+
+    /**
+     * Function: closeUntilGrippedAsync
+     * Starts closing the claw until it grips an object (see
+     * closeUntilGripped), and returns immediately.
+     *
+     * @return A handle that completes successfully once an object is gripped,
+     * or unsuccessfully if the grip times out, is replaced by another command
+     * or is refused because the claw is homing
+     */
+    std::shared_ptr<Completion> closeUntilGrippedAsync();
+
+    /**
+     * Function: isBusy
+     * @return Whether a non-blocking command is currently running
+     */
+    bool isBusy();
+
+    /**
+     * Function: isGripping
+     * @return Whether the claw is currently gripping an object after
+     * closeUntilGripped
+     */
+    bool isGripping();
+
+    /**
+     * Function: home
+     * Drives the claw slowly open into its hard stop, detects the stall from
+     * the motors' current draw and velocity, and zeroes the motor encoders
+     * there. Driver control is ignored while homing. Blocks until done.
+     *
+     * @return Whether the hard stop was found before timing out. If not, the
+     * encoders are left alone
+     */
+    bool home();
+
+    /**
+     * Function: homeAsync
+     * Runs home in its own task and returns immediately, so homing can be
+     * started at the start of autonomous or opcontrol without delaying them
+     * (the motors don't run while the robot is disabled, so homing in
+     * initialize or competition_initialize would just time out). Does nothing
+     * if homing is already in progress
+     */
+    void homeAsync();
+
+    /**
+     * Function: isHomed
+     * @return Whether the claw has been successfully homed
+     */
+    bool isHomed();
+
+    /**
+     * Function: getInputLatency
+     * @return The histogram of times from a controller snapshot to the motor
+     * write it caused in driver control
+     */
+    LatencyHistogram& getInputLatency();
 };
 
 #endif /* Claw.hpp */
\ No newline at end of file
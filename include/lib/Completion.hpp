@@ -0,0 +1,55 @@
+#ifndef COMPLETION_HPP
+#define COMPLETION_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * \file Completion.hpp
+ *
+ * The Completion class is a handle returned by non-blocking commands, such as
+ * the asynchronous Claw functions. The task running the command marks it done
+ * when the command finishes, and the code that started the command can check
+ * on it or wait for it without blocking anything else.
+ */
+class Completion {
+   private:
+    // Whether the command has finished, and whether it succeeded
+    std::atomic<bool> done{false};
+    std::atomic<bool> succeeded{false};
+
+   public:
+    /**
+     * Function: finish
+     * Marks the command as finished. Called by whatever runs the command
+     *
+     * @param success Whether the command succeeded (false if it timed out or
+     * was replaced by another command)
+     */
+    void finish(bool success);
+
+    /**
+     * Function: isDone
+     * @return Whether the command has finished
+     */
+    bool isDone();
+
+    /**
+     * Function: wasSuccessful
+     * @return Whether the command finished successfully. Always false while
+     * the command is still running
+     */
+    bool wasSuccessful();
+
+    /**
+     * Function: wait
+     * Blocks the calling task until the command finishes
+     *
+     * @param timeout The longest to wait, in milliseconds. Defaults to waiting
+     * forever
+     * @return Whether the command finished successfully
+     */
+    bool wait(std::uint32_t timeout = UINT32_MAX);
+};
+
+#endif /* Completion.hpp */
@@ -0,0 +1,78 @@
+#ifndef CONTROLLERARBITER_HPP
+#define CONTROLLERARBITER_HPP
+
+#include "lib/ControllerState.hpp"
+
+/**
+ * \file ControllerArbiter.hpp
+ *
+ * The ControllerArbiter class samples the master and partner controllers
+ * together once per tick, and hands each subsystem the input it is mapped to:
+ * one of the controllers, or both combined. If a controller disconnects, the
+ * subsystems mapped to it fall back to the other one.
+ */
+/**
+ * Where a subsystem takes its input from. shared combines both controllers:
+ * the master's joysticks win whenever they are outside the deadband (the
+ * partner's are used otherwise), and a button counts as pressed if it is
+ * pressed on either controller.
+ */
+enum class ControlSource { master, partner, shared };
+
+class ControllerArbiter {
+   private:
+    // The snapshots of each controller, and the two combined
+    ControllerState master{pros::E_CONTROLLER_MASTER};
+    ControllerState partner{pros::E_CONTROLLER_PARTNER};
+    ControllerState shared{pros::E_CONTROLLER_MASTER};
+
+    /**
+     * How far, out of 127, the master's joysticks have to move to take over
+     * from the partner's in the shared input
+     */
+    int deadband = 10;
+
+   public:
+    /**
+     * Function: update
+     * Samples both controllers and combines them. Called once at the start of
+     * each opcontrol tick
+     */
+    void update();
+
+    /**
+     * Function: combine
+     * Combines the two controllers' snapshots into the shared input. Called by
+     * update, or after setting both snapshots (see getRaw) from a recording
+     */
+    void combine();
+
+    /**
+     * Function: get
+     * @param source The input to get
+     * @return The snapshot for the source, or for the other controller if the
+     * source's controller is disconnected
+     */
+    ControllerState& get(ControlSource source);
+
+    /**
+     * Function: getRaw
+     * Gets a controller's own snapshot, without failing over, for recording
+     * it or setting it from a recording
+     *
+     * @param source The controller to get (master or partner)
+     * @return The controller's snapshot
+     */
+    ControllerState& getRaw(ControlSource source);
+
+    /**
+     * Function: setDeadband
+     * Sets how far the master's joysticks have to move to take over from the
+     * partner's in the shared input
+     *
+     * @param threshold The deadband, out of 127
+     */
+    void setDeadband(int threshold);
+};
+
+#endif /* ControllerArbiter.hpp */
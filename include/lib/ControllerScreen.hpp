@@ -0,0 +1,95 @@
+#ifndef CONTROLLERSCREEN_HPP
+#define CONTROLLERSCREEN_HPP
+
+#include <cstdint>
+
+#include "api.h"
+
+/**
+ * \file ControllerScreen.hpp
+ *
+ * The ControllerScreen class queues text and rumbles for a controller. The
+ * controller only takes one screen or rumble update about every 50 ms, so
+ * writing to it directly from subsystem code either loses messages or holds up
+ * the caller. Instead, subsystems post messages here, which returns right away,
+ * and a background task sends the highest priority message every 50 ms.
+ * Posting a line that is already shown or waiting to be sent does nothing, so
+ * subsystems can post as often as they like.
+ */
+class ControllerScreen {
+   private:
+    // The controller the messages are sent to
+    pros::controller_id_e_t controller;
+
+    /**
+     * One line of the screen. shown is the text last sent to the controller,
+     * and pending is the text waiting to be sent (if dirty is true), with its
+     * priority. Lines are padded to the full 15 characters so that shorter
+     * text covers up longer text from before.
+     */
+    struct Line {
+        char shown[16] = "";
+        char pending[16] = "";
+        bool dirty = false;
+        int priority = 0;
+    };
+    Line lines[3];
+
+    // The rumble pattern waiting to be sent, if rumbleDirty is true
+    char rumblePattern[9] = "";
+    bool rumbleDirty = false;
+    int rumblePriority = 0;
+
+    // Keeps the queue consistent between the background task and post/rumble
+    pros::Mutex mutex;
+    pros::Task* task = NULL;
+
+    /**
+     * Function: sendNext
+     * Sends the highest priority waiting message, if any. Rumbles win ties,
+     * followed by lines from the top down. Called by the background task
+     * every 50 ms.
+     */
+    void sendNext();
+
+   public:
+    /**
+     * The constructor for the ControllerScreen class
+     *
+     * @param controller The controller to send messages to (CONTROLLER_MASTER
+     * or CONTROLLER_PARTNER)
+     */
+    ControllerScreen(pros::controller_id_e_t controller);
+
+    /**
+     * Function: start
+     * Starts the background task that sends messages, if it hasn't been
+     * started already. It runs below the default priority, so it never delays
+     * the control loop.
+     */
+    void start();
+
+    /**
+     * Function: post
+     * Queues text to show on a line of the screen. Replaces any text already
+     * waiting for that line
+     *
+     * @param line The line to show the text on (0 - 2)
+     * @param text The text to show. Only the first 15 characters fit
+     * @param priority Messages with higher priorities are sent first
+     */
+    void post(int line, const char* text, int priority = 0);
+
+    /**
+     * Function: rumble
+     * Queues a rumble. Replaces any rumble already waiting with the same or a
+     * lower priority
+     *
+     * @param pattern The rumble pattern: '.' for a short rumble, '-' for a
+     * long one and ' ' for a pause, up to 8 characters
+     * @param priority Messages with higher priorities are sent first
+     */
+    void rumble(const char* pattern, int priority = 0);
+};
+
+#endif /* ControllerScreen.hpp */
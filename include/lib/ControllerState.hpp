@@ -0,0 +1,204 @@
+#ifndef CONTROLLERSTATE_HPP
+#define CONTROLLERSTATE_HPP
+
+#include <cstdint>
+
+#include "api.h"
+#include "lib/LatencyHistogram.hpp"
+
+/**
+ * \file ControllerState.hpp
+ *
+ * The ControllerState class is a snapshot of a controller, read once per
+ * opcontrol tick and passed to every subsystem's driver function. Every
+ * subsystem sees the same inputs within a tick, the controller is only read
+ * once, and the edges of each button (the tick it was pressed or released) are
+ * worked out in one place.
+ */
+class ControllerState {
+   private:
+    // The controller the snapshot is read from
+    pros::controller_id_e_t controller;
+
+    // The value of each joystick axis, indexed by pros::controller_analog_e_t
+    int axes[4] = {0, 0, 0, 0};
+
+    /**
+     * The buttons held down this tick and last tick, as bitmasks with one bit
+     * per button (see getButtonMask)
+     */
+    std::uint16_t buttons = 0;
+    std::uint16_t prevButtons = 0;
+
+    /**
+     * The axes (one bit per pros::controller_analog_e_t) and buttons bound by
+     * the driver functions, which are the only ones update reads, and the
+     * buttons read by the last update. An input is bound the first time a
+     * driver function gets it, so inputs nothing uses are never read
+     */
+    std::uint8_t boundAxes = 0;
+    std::uint16_t boundButtons = 0;
+    std::uint16_t readButtons = 0;
+
+    // Whether the controller was connected when the snapshot was taken
+    bool connected = false;
+
+    /**
+     * When the snapshot was taken (from pros::micros), so mechanisms can
+     * measure the latency from input to output, and the time between
+     * snapshots, which adds to every mechanism's latency
+     */
+    std::uint64_t timestamp = 0;
+    LatencyHistogram sampleInterval;
+
+    /**
+     * Function: stamp
+     * Records the time of a new snapshot
+     *
+     * @param time When the snapshot was taken, from pros::micros
+     */
+    void stamp(std::uint64_t time);
+
+   public:
+    /**
+     * The constructor for the ControllerState class
+     *
+     * @param controller The controller to read (CONTROLLER_MASTER or
+     * CONTROLLER_PARTNER)
+     */
+    ControllerState(pros::controller_id_e_t controller);
+
+    /**
+     * Function: update
+     * Reads the bound axes and buttons of the controller. Called once at the
+     * start of each opcontrol tick. An input reads as 0 (released) until the
+     * update after it is first bound, and a button doesn't count as newly
+     * pressed on its first reading
+     */
+    void update();
+
+    /**
+     * Function: set
+     * Sets the snapshot to given inputs instead of reading the controller,
+     * such as when replaying a recording. Edges are worked out the same way
+     * as in update
+     *
+     * @param newAxes The value of each joystick axis, indexed by
+     * pros::controller_analog_e_t
+     * @param newButtons The buttons held down, as a bitmask (see
+     * getButtonMask)
+     * @param time When the inputs were read, from pros::micros. Defaults to
+     * now
+     * @param isConnected Whether the controller was connected. Defaults to
+     * true
+     */
+    void set(const int newAxes[4], std::uint16_t newButtons,
+             std::uint64_t time = 0, bool isConnected = true);
+
+    /**
+     * Function: getController
+     * @return The controller the snapshot is read from, for anything the
+     * snapshot doesn't cover (such as rumble or the screen)
+     */
+    pros::controller_id_e_t getController();
+
+    /**
+     * Function: isConnected
+     * @return Whether the controller was connected when the snapshot was taken
+     * (or set)
+     */
+    bool isConnected();
+
+    /**
+     * Function: bind
+     * Adds axes and buttons for update to read, on top of the ones bound by
+     * getting them. Used to read inputs that are got from another snapshot
+     *
+     * @param axes The axes to bind, one bit per pros::controller_analog_e_t
+     * @param buttons The buttons to bind, as a bitmask (see getButtonMask)
+     */
+    void bind(std::uint8_t axes, std::uint16_t buttons);
+
+    /**
+     * Functions: getBoundAxes, getBoundButtons
+     * @return The axes (one bit per pros::controller_analog_e_t) and buttons
+     * (see getButtonMask) bound so far
+     */
+    std::uint8_t getBoundAxes();
+    std::uint16_t getBoundButtons();
+
+    /**
+     * Function: getAnalog
+     * Binds the axis, if it isn't already
+     *
+     * @param axis The joystick axis to get
+     * @return The value of the axis, from -127 to 127
+     */
+    int getAnalog(pros::controller_analog_e_t axis);
+
+    /**
+     * Function: getDigital
+     * Binds the button, if it isn't already
+     *
+     * @param button The button to check
+     * @return Whether the button is held down
+     */
+    bool getDigital(pros::controller_digital_e_t button);
+
+    /**
+     * Function: getNewPress
+     * Binds the button, if it isn't already
+     *
+     * @param button The button to check
+     * @return Whether the button was pressed this tick (a rising edge)
+     */
+    bool getNewPress(pros::controller_digital_e_t button);
+
+    /**
+     * Function: getNewRelease
+     * Binds the button, if it isn't already
+     *
+     * @param button The button to check
+     * @return Whether the button was released this tick (a falling edge)
+     */
+    bool getNewRelease(pros::controller_digital_e_t button);
+
+    /**
+     * Function: getAxes
+     * Gets every axis without binding any, for passing the whole snapshot on
+     *
+     * @return The value of each joystick axis, indexed by
+     * pros::controller_analog_e_t
+     */
+    const int* getAxes();
+
+    /**
+     * Function: getButtons
+     * Gets every button without binding any, for passing the whole snapshot on
+     *
+     * @return The buttons held down, as a bitmask (see getButtonMask)
+     */
+    std::uint16_t getButtons();
+
+    /**
+     * Function: getButtonMask
+     * @param button A controller button
+     * @return The bit representing the button in the button bitmasks. The 12
+     * buttons take up the lowest 12 bits, from L1 to A
+     */
+    static std::uint16_t getButtonMask(pros::controller_digital_e_t button);
+
+    /**
+     * Function: getTimestamp
+     * @return When the snapshot was taken, in microseconds (from pros::micros)
+     */
+    std::uint64_t getTimestamp();
+
+    /**
+     * Function: getSampleInterval
+     * @return The histogram of times between snapshots
+     */
+    LatencyHistogram& getSampleInterval();
+};
+
+#endif /* ControllerState.hpp */
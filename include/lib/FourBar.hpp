@@ -1,9 +1,15 @@
 #ifndef FOURBAR_HPP
 #define FOURBAR_HPP
 
+#include <atomic>
 #include <initializer_list>
 
+#include "api.h"
+#include "lib/ControllerState.hpp"
+#include "lib/LatencyHistogram.hpp"
+#include "lib/Mechanism.hpp"
 #include "lib/MotorGroup.hpp"
+#include "lib/PneumaticClaw.hpp"
 
 /**
  * \file FourBar.hpp
@@ -11,7 +17,28 @@
  * The FourBar class is used to abstract a 4-bar four bar lift design. It
  * provides a simple interface to control a MotorGroup.
  */
-class FourBar {
+/**
+ * Named preset heights for the four bar lift, in order from lowest to
+ * highest.
+ */
+enum class LiftPreset { floor, carry, platform, max };
+
+/**
+ * The states of the driver control state machine. In manual, the lift is moved
+ * by holding the up/down buttons. In movingToPreset, the position controller is
+ * moving the lift to a preset, and in atPreset, it has reached it.
+ */
+enum class LiftState { manual, movingToPreset, atPreset };
+
+/**
+ * How the lift holds its position above the hold threshold. brake uses the
+ * motors' built-in E_MOTOR_BRAKE_HOLD, which holds at full current. active
+ * holds with the gravity feedforward plus a small position correction under a
+ * reduced current limit, falling back to brake only when disturbed.
+ */
+enum class HoldMode { brake, active };
+
+class FourBar : public Mechanism {
    private:
     // The MotorGroup that represents the motors on the four bar lift
     MotorGroup motors;
@@ -40,6 +67,159 @@ class FourBar {
      */
     double holdThreshold = 0;
 
+    /**
+     * Position controller settings. The controller runs in periodic (every 10
+     * ms unless changed by setPositionControl), setting the motors' velocity to
+     * kP_position (RPM per degree of motor rotation) times the error, capped by
+     * the maximum up/down speeds and the speed of the current movement. The
+     * lift is settled once it has stayed within settleTolerance motor degrees
+     * of the target for 3 cycles. If it instead moves less than half a motor
+     * degree a cycle for 50 cycles (such as under a goal too heavy to lift),
+     * the movement gives up.
+     */
+    double kP_position = 1.0;
+    double settleTolerance = 5;
+
+    /**
+     * Position controller state. targetPosition is in motor degrees, and
+     * targetSpeed is the speed limit of the current movement, in RPM.
+     * positionControl is true while the controller is moving the lift, and
+     * reachedTarget is whether the last movement settled at its target
+     * (rather than stalling or timing out). controllerMutex keeps the state
+     * consistent between periodic and the functions that set it.
+     */
+    double targetPosition = 0;
+    int targetSpeed = 0;
+    bool positionControl = false;
+    bool reachedTarget = false;
+    int settledCount = 0;
+    int stalledCount = 0;
+    double prevControlPosition = 0;
+    pros::Mutex controllerMutex;
+
+    /**
+     * The time from each controller snapshot to the motor write it caused.
+     * Presets are carried out by periodic, so presetInputTime holds the
+     * timestamp of the snapshot that started a preset (0 once it has been
+     * recorded) until periodic first moves the motors.
+     */
+    LatencyHistogram inputLatency;
+    std::uint64_t presetInputTime = 0;
+
+    /**
+     * The heights of each preset, indexed by the LiftPreset enum, in degrees of
+     * lift (not motor) rotation from the zero position.
+     */
+    double presetHeights[4] = {0, 15, 45, 75};
+
+    // The driver control state, and the preset the lift is at or moving to
+    LiftState state = LiftState::manual;
+    LiftPreset currentPreset = LiftPreset::floor;
+
+    /**
+     * Function: nextPreset
+     * Finds the preset to move to when cycling up or down. From a preset, this
+     * is the next one in that direction. In manual control, it is the nearest
+     * preset in that direction from the lift's current height.
+     *
+     * @param up Whether to cycle up (true) or down (false)
+     * @return The preset to move to
+     */
+    LiftPreset nextPreset(bool up);
+
+    /**
+     * Gravity compensation settings. The torque needed to hold the lift up
+     * varies with the cosine of the arm's angle from horizontal, so the
+     * position controller adds kG * cos(angle) millivolts to its output.
+     * kG_loaded is used instead of kG while the payload claw (if set) is
+     * closed on a goal. horizontalAngle is the angle of the lift (not the
+     * motors) from its zero position at which the arms are horizontal.
+     *
+     * With both kG values at 0, gravity compensation is off and the controller
+     * uses the motors' built-in velocity control.
+     */
+    double kG = 0, kG_loaded = 0;
+    double horizontalAngle = 0;
+    PneumaticClaw* payloadClaw = NULL;
+
+    /**
+     * Active hold settings. kP_hold is the position correction, in millivolts
+     * per degree of motor rotation, and holdCurrentLimit is the current limit
+     * (in mA) while actively holding. If the lift is pushed more than
+     * disturbanceThreshold motor degrees from the hold position for 5 cycles,
+     * the lift falls back to brake holding for half a second before going back
+     * to actively holding wherever it ends up.
+     */
+    HoldMode holdMode = HoldMode::brake;
+    double kP_hold = 20;
+    int holdCurrentLimit = 800;
+    double disturbanceThreshold = 15;
+
+    /**
+     * Active hold state. holding is true while the controller is holding the
+     * lift at holdPosition (in motor degrees). disturbedCount counts cycles
+     * spent past the disturbance threshold, and brakeCount counts the cycles
+     * left in a brake hold fallback.
+     */
+    bool holding = false;
+    double holdPosition = 0;
+    int disturbedCount = 0;
+    int brakeCount = 0;
+
+    /**
+     * Function: rest
+     * Stops the lift after a movement: coasts below the hold threshold, and
+     * holds (in the configured hold mode) above it. Must be called with
+     * controllerMutex taken.
+     */
+    void rest();
+
+    /**
+     * Function: release
+     * Ends any active hold, restoring the full current limit. Must be called
+     * with controllerMutex taken.
+     */
+    void release();
+
+    /**
+     * Function: updateHold
+     * Runs one cycle of active holding. Called by updateController.
+     */
+    void updateHold();
+
+    /**
+     * Homing settings. Homing drives the lift down at homingSpeed RPM until the
+     * motors stall against the hard stop (drawing over homingCurrent mA while
+     * moving under 5 RPM), then zeroes the motor encoders. Homing gives up
+     * after homingTimeout milliseconds.
+     */
+    int homingSpeed = 30;
+    double homingCurrent = 1200;
+    std::uint32_t homingTimeout = 3000;
+
+    /**
+     * Whether homing is in progress, and whether it has succeeded. Set by the
+     * homing task and read by the others. Position commands are refused (or,
+     * if blocking, wait) while homing, as the encoders are about to be zeroed.
+     * homingCancelled is set by driver to stop homing early
+     */
+    std::atomic<bool> homing{false};
+    std::atomic<bool> homed{false};
+    std::atomic<bool> homingCancelled{false};
+
+    /**
+     * Function: getGravityFeedforward
+     * @return The voltage needed to hold the lift at its current angle, in
+     * millivolts
+     */
+    double getGravityFeedforward();
+
+    /**
+     * Function: updateController
+     * Runs one cycle of the position controller. Called by periodic.
+     */
+    void updateController();
+
    public:
     /**
      * The constructor for the Lift class
@@ -49,6 +229,13 @@ class FourBar {
      */
     FourBar(std::initializer_list<int> ports, std::initializer_list<bool> revs);
 
+    /**
+     * Function: periodic
+     * Runs the position controller and active hold. Called every period by a
+     * Scheduler, or by the lift's own task once position control is used
+     */
+    void periodic() override;
+
     /*-------------------------
      * Configuration functions
      *-------------------------*/
@@ -102,6 +289,73 @@ class FourBar {
      * should begin holding their position
      */
     void setHoldThreshold(double degrees);
+
+    /**
+     * Function: setPositionControl
+     * This function configures the background position controller used by
+     * moveToAsync and moveTo
+     *
+     * @param kP The proportional constant, in RPM per degree of motor rotation
+     * @param tolerance How close to the target the motors need to be to be
+     * settled, in degrees of motor rotation
+     * @param period How often the controller runs, in milliseconds. Defaults to
+     * 10 (the rate the motors update at)
+     */
+    void setPositionControl(double kP, double tolerance,
+                            std::uint32_t period = 10);
+
+    /**
+     * Function: setHoldMode
+     * This function sets how the lift holds its position above the hold
+     * threshold. Active holding needs gravity compensation to be configured.
+     *
+     * @param mode The hold mode to use
+     * @param kP The position correction while actively holding, in millivolts
+     * per degree of motor rotation
+     * @param currentLimit The current limit while actively holding, in mA
+     * @param disturbance How far (in degrees of motor rotation) the lift has to
+     * be pushed from its hold position to fall back to brake holding
+     */
+    void setHoldMode(HoldMode mode, double kP, int currentLimit,
+                     double disturbance);
+
+    /**
+     * Function: setHoming
+     * This function configures homing, which finds the lift's zero position by
+     * driving it into its lower hard stop
+     *
+     * @param speed The speed to drive down at while homing, in RPM
+     * @param current The current draw, in mA, that indicates the lift has
+     * reached the hard stop (along with the motors barely moving)
+     * @param timeout How long to try homing before giving up, in milliseconds
+     */
+    void setHoming(int speed, double current, std::uint32_t timeout);
+
+    /**
+     * Function: setPresetHeight
+     * This function sets the height of one of the lift presets
+     *
+     * @param preset The preset to set the height of
+     * @param degrees The height of the preset, in degrees of lift rotation from
+     * the zero position
+     */
+    void setPresetHeight(LiftPreset preset, double degrees);
+
+    /**
+     * Function: setGravityCompensation
+     * This function configures the gravity feedforward used by the position
+     * controller. The feedforward is kG * cos(angle from horizontal), so kG is
+     * the voltage needed to hold the arms horizontal.
+     *
+     * @param empty The value of kG without a goal, in millivolts
+     * @param loaded The value of kG while carrying a goal, in millivolts
+     * @param horizontal The angle of the lift (not the motors) from its zero
+     * position at which the arms are horizontal, in degrees
+     * @param claw A pointer to the claw that holds goals on the lift. While it
+     * is closed, the loaded value is used. Defaults to NULL (always empty)
+     */
+    void setGravityCompensation(double empty, double loaded, double horizontal,
+                                PneumaticClaw* claw = NULL);
     /*-------------------
      * Movement functions
      *-------------------*/
@@ -109,17 +363,48 @@ class FourBar {
     /**
      * Function: driver
      * This function is used to control the four bar lift while in opcontrol.
+     * Pressing either button takes over from any movement started with
+     * moveToAsync.
      *
-     * @param controller The controller ID representing the physical controller
+     * @param controller The snapshot of the controller for this tick
      * @param upButton The button on the controller used to move the four bar
      * lift up
      * @param downButton The button on the controller used to move the four bar
      * lift down
      */
-    void driver(pros::controller_id_e_t controller,
+    void driver(ControllerState& controller,
                 pros::controller_digital_e_t upButton,
                 pros::controller_digital_e_t downButton);
 
+    /**
+     * Function: driver
+     * This implementation of the driver function adds preset heights on top of
+     * manual control. A single press of a preset button cycles the lift to the
+     * next preset up or down, which it moves to on the background position
+     * controller, leaving the driver in full control of the drive. Holding a
+     * manual button switches back to manual control.
+     *
+     * @param controller The snapshot of the controller for this tick
+     * @param upButton The button used to move the lift up manually
+     * @param downButton The button used to move the lift down manually
+     * @param presetUpButton The button used to cycle up to the next preset
+     * @param presetDownButton The button used to cycle down to the next preset
+     */
+    void driver(ControllerState& controller,
+                pros::controller_digital_e_t upButton,
+                pros::controller_digital_e_t downButton,
+                pros::controller_digital_e_t presetUpButton,
+                pros::controller_digital_e_t presetDownButton);
+
+    /**
+     * Function: goToPreset
+     * Jumps to a preset, starting the movement on the background position
+     * controller and returning immediately. Does nothing while homing
+     *
+     * @param preset The preset to move to
+     */
+    void goToPreset(LiftPreset preset);
+
     /**
      * Function: up
      * Wraps the MotorGroup calls to move the four bar lift up
@@ -132,17 +417,123 @@ class FourBar {
     void down();
     /**
      * Function: stop
-     * Wraps the MotorGroup calls to stop the four bar lift
+     * Wraps the MotorGroup calls to stop the four bar lift. Above the hold
+     * threshold, the lift holds position using the configured hold mode.
      */
     void stop();
 
     /**
      * Function: moveTo
-     * Moves the four bar lift to a specific "rotation" from its zero position
+     * Moves the four bar lift to a specific "rotation" from its zero position.
+     * Blocks until the lift has settled at the target, after waiting for
+     * homing.
+     *
      * @param degrees The degree position to move the four bar lift to
      * @param speed The speed at which the motors should run at
+     * @param timeout The longest to wait for the lift to settle, in
+     * milliseconds. Defaults to no limit (the movement still gives up if the
+     * lift stalls)
+     * @return Whether the lift settled at the target
+     */
+    bool moveTo(double degrees, int speed,
+                std::uint32_t timeout = UINT32_MAX);
+
+    /**
+     * Function: moveToAsync
+     * Starts moving the four bar lift to a specific "rotation" from its zero
+     * position, and returns immediately. The movement is run by the background
+     * position controller, so the lift can move while the drive is moving.
+     *
+     * @param degrees The degree position to move the four bar lift to
+     * @param speed The maximum speed of the motors, in RPM. Defaults to 0,
+     * which uses the maximum up/down speeds
+     * @return Whether the movement started (false while homing)
+     */
+    bool moveToAsync(double degrees, int speed = 0);
+
+    /**
+     * Function: isSettled
+     * @return Whether the lift has finished the movement started by
+     * moveToAsync (true if there is no movement in progress)
+     */
+    bool isSettled();
+
+    /**
+     * Function: waitUntilSettled
+     * Blocks until the lift has finished the movement started by moveToAsync.
+     * If the timeout runs out first, the movement is stopped
+     *
+     * @param timeout The longest to wait, in milliseconds. Defaults to no
+     * limit (the movement still gives up if the lift stalls)
+     * @return Whether the lift settled at the target
+     */
+    bool waitUntilSettled(std::uint32_t timeout = UINT32_MAX);
+
+    /**
+     * Function: home
+     * Drives the lift slowly into its lower hard stop, detects the stall from
+     * the motors' current draw and velocity, and zeroes the motor encoders
+     * there. Driver control is ignored while homing, except that holding the
+     * manual up or down button cancels it. Blocks until done.
+     *
+     * @return Whether the hard stop was found before timing out or being
+     * cancelled. If not, the encoders are left alone
+     */
+    bool home();
+
+    /**
+     * Function: homeAsync
+     * Runs home in its own task and returns immediately, so homing can be
+     * started at the start of autonomous or opcontrol without delaying them
+     * (the motors don't run while the robot is disabled, so homing in
+     * initialize or competition_initialize would just time out). Does nothing
+     * if homing is already in progress
+     */
+    void homeAsync();
+
+    /*--------------------
+     * Telemetry Functions
+     *--------------------*/
+    /**
+     * Function: getAngle
+     * Gets the angle of the four bar lift itself (rather than the motors) from
+     * its zero position, accounting for the external gear ratio
+     *
+     * @return The angle of the four bar lift, in degrees
+     */
+    double getAngle();
+
+    /**
+     * Function: getTemperature
+     * @return The temperature of the hottest lift motor, in degrees Celsius
+     */
+    double getTemperature();
+
+    /**
+     * Function: isHomed
+     * @return Whether the lift has been successfully homed
+     */
+    bool isHomed();
+
+    /**
+     * Function: getState
+     * @return The current state of the driver control state machine
+     */
+    LiftState getState();
+
+    /**
+     * Function: getPreset
+     * @return The preset the lift is at or moving to. Only meaningful outside
+     * of manual control
+     */
+    LiftPreset getPreset();
+
+    /**
+     * Function: getInputLatency
+     * @return The histogram of times from a controller snapshot to the motor
+     * write it caused in driver control
      */
-    void moveTo(double degrees, int speed);
+    LatencyHistogram& getInputLatency();
 };
 
 #endif /* FourBar.hpp */
\ No newline at end of file
@@ -0,0 +1,216 @@
+#ifndef INPUTRECORDER_HPP
+#define INPUTRECORDER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "api.h"
+#include "lib/ControllerState.hpp"
+
+/**
+ * \file InputRecorder.hpp
+ *
+ * The InputRecorder class records the master and partner controller snapshots
+ * during driver control to the SD card, and plays recordings back into a pair
+ * of ControllerStates so they run through the same arbitration and driver
+ * functions. A good driver run can then be turned into an autonomous routine,
+ * and a driver-reported problem can be reproduced exactly.
+ *
+ * Recordings start with a header: the characters "VIR2" and the tick period in
+ * milliseconds (one byte). Each tick is then a frame for the master
+ * controller followed by one for the partner:
+ *  - A flags byte. Bits 0-3 are set for each joystick axis that changed, bit 4
+ *    is set if the buttons changed, and bit 6 is set if the controller is
+ *    disconnected
+ *  - The change in each changed axis, zigzag encoded as a varint (one byte for
+ *    changes under 64)
+ *  - The button bitmask, if it changed (two bytes, low byte first)
+ * A connected controller where nothing changed is a single zero byte. A tick
+ * starting with a flags byte of 0x20 is instead a varint tick count, for ticks
+ * that couldn't be recorded (see record), during which the inputs stay the
+ * same.
+ */
+class InputRecorder {
+   private:
+    /**
+     * The buffer between record, called from the control loop, and the writer
+     * task, which writes to the SD card. record only ever adds to head and the
+     * writer task only ever adds to tail, so neither has to wait on the other.
+     */
+    static const int bufferSize = 4096;
+    std::uint8_t buffer[bufferSize];
+    std::atomic<int> head{0};
+    std::atomic<int> tail{0};
+
+    // The file being recorded to, and whether recording is in progress
+    FILE* file = NULL;
+    std::atomic<bool> recording{false};
+
+    // The number of controllers in each tick (the master, then the partner)
+    static const int controllerCount = 2;
+
+    /**
+     * The last inputs recorded for each controller, which the next frames are
+     * encoded against, and the number of ticks since then that didn't fit in
+     * the buffer
+     */
+    int recordedAxes[controllerCount][4] = {};
+    std::uint16_t recordedButtons[controllerCount] = {};
+    std::uint32_t skippedTicks = 0;
+    std::uint32_t droppedTicks = 0;
+
+    /**
+     * Playback state. The whole recording is loaded into playbackData, and
+     * playbackPos is the position of the next frame. playedAxes,
+     * playedButtons and playedConnected are each controller's inputs played
+     * so far, and holdTicks is the number of ticks left in a gap.
+     */
+    std::vector<std::uint8_t> playbackData;
+    std::size_t playbackPos = 0;
+    bool playing = false;
+    int playedAxes[controllerCount][4] = {};
+    std::uint16_t playedButtons[controllerCount] = {};
+    bool playedConnected[controllerCount] = {true, true};
+    std::uint32_t holdTicks = 0;
+
+    // The tick period of the current recording or playback, in milliseconds
+    std::uint32_t tickPeriod = 20;
+
+    /**
+     * Function: push
+     * Adds data to the buffer, if all of it fits
+     *
+     * @param data The data to add
+     * @param length The number of bytes to add
+     * @return Whether the data fit
+     */
+    bool push(const std::uint8_t* data, int length);
+
+    /**
+     * Function: writeBuffer
+     * Writes everything in the buffer to the file. Called by the writer task
+     */
+    void writeBuffer();
+
+    /**
+     * Function: encodeFrame
+     * Encodes one controller's frame against its last recorded inputs
+     *
+     * @param state The snapshot of the controller
+     * @param index The controller's index in the tick (0 for the master)
+     * @param out Where to write the frame (up to 11 bytes)
+     * @return The number of bytes written
+     */
+    int encodeFrame(ControllerState& state, int index, std::uint8_t* out);
+
+    /**
+     * Function: readFrame
+     * Reads one controller's frame from the recording being played back into
+     * its played inputs
+     *
+     * @param index The controller's index in the tick (0 for the master)
+     * @return Whether a whole frame was read before the end of the recording
+     */
+    bool readFrame(int index);
+
+    /**
+     * Function: encodeVarint
+     * Encodes a number 7 bits at a time, with the top bit of each byte set if
+     * more bytes follow
+     *
+     * @param value The number to encode
+     * @param out Where to write the encoded bytes (up to 5)
+     * @return The number of bytes written
+     */
+    static int encodeVarint(std::uint32_t value, std::uint8_t* out);
+
+    /**
+     * Function: readVarint
+     * Reads a varint from the recording being played back
+     *
+     * @param value Set to the number read
+     * @return Whether a whole varint was read before the end of the recording
+     */
+    bool readVarint(std::uint32_t& value);
+
+   public:
+    /**
+     * Function: startRecording
+     * Opens a file on the SD card and starts the writer task. Call record
+     * every tick after this
+     *
+     * @param path The file to record to, such as "/usd/run0.bin"
+     * @param period The tick period of the control loop, in milliseconds
+     * @return Whether the file could be opened (false if there is no SD card,
+     * or a recording is still being written)
+     */
+    bool startRecording(const char* path, std::uint32_t period);
+
+    /**
+     * Function: record
+     * Records one tick of inputs. Never waits on the SD card: if the buffer is
+     * full, the tick is counted and recorded as part of a gap instead. Does
+     * nothing if not recording.
+     *
+     * @param master The snapshot of the master controller for this tick
+     * @param partner The snapshot of the partner controller for this tick
+     */
+    void record(ControllerState& master, ControllerState& partner);
+
+    /**
+     * Function: stopRecording
+     * Stops recording. The writer task finishes writing the buffer and closes
+     * the file in the background
+     */
+    void stopRecording();
+
+    /**
+     * Function: isRecording
+     * @return Whether a recording is in progress
+     */
+    bool isRecording();
+
+    /**
+     * Function: getDroppedTicks
+     * @return The number of ticks in the current recording that didn't fit in
+     * the buffer
+     */
+    std::uint32_t getDroppedTicks();
+
+    /**
+     * Function: startPlayback
+     * Loads a recording from the SD card to play back. Blocks while the file
+     * is read, so should be called before the control loop starts
+     *
+     * @param path The file to play back
+     * @return Whether the file was loaded
+     */
+    bool startPlayback(const char* path);
+
+    /**
+     * Function: play
+     * Plays back one tick of inputs
+     *
+     * @param master Set to the master controller's inputs for this tick
+     * @param partner Set to the partner controller's inputs for this tick
+     * @return Whether there was a tick to play (false once the recording ends)
+     */
+    bool play(ControllerState& master, ControllerState& partner);
+
+    /**
+     * Function: isPlaying
+     * @return Whether a recording is being played back
+     */
+    bool isPlaying();
+
+    /**
+     * Function: getTickPeriod
+     * @return The tick period of the current recording or playback, in
+     * milliseconds. Playback should call play at this rate
+     */
+    std::uint32_t getTickPeriod();
+};
+
+#endif /* InputRecorder.hpp */
@@ -0,0 +1,80 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <cstdint>
+
+#include "api.h"
+
+/**
+ * \file LatencyHistogram.hpp
+ *
+ * The LatencyHistogram class collects latencies, such as the time from a
+ * controller sample to the motor or solenoid write it caused, into fixed
+ * buckets. Recording a latency is cheap enough to do every tick, and the
+ * histogram can be printed to the terminal to see where input delay comes
+ * from. Latencies can be recorded and read from different tasks, such as the
+ * control loop and a telemetry task.
+ */
+class LatencyHistogram {
+   private:
+    /**
+     * The upper limit of each bucket, in microseconds. The last bucket holds
+     * everything over the last limit.
+     */
+    static const int bucketCount = 10;
+    static const std::uint32_t bucketLimits[bucketCount - 1];
+
+    // The number of latencies in each bucket
+    std::uint32_t counts[bucketCount] = {};
+
+    // The number of latencies recorded, their total and the largest, in
+    // microseconds
+    std::uint32_t samples = 0;
+    std::uint64_t total = 0;
+    std::uint32_t maxLatency = 0;
+
+    // Keeps the counts consistent between the tasks recording and reading them
+    pros::Mutex mutex;
+
+   public:
+    /**
+     * Function: record
+     * Adds a latency to the histogram
+     *
+     * @param latency The latency, in microseconds
+     */
+    void record(std::uint32_t latency);
+
+    /**
+     * Function: recordSince
+     * Adds the time since a timestamp to the histogram
+     *
+     * @param start The timestamp, from pros::micros
+     */
+    void recordSince(std::uint64_t start);
+
+    /**
+     * Function: reset
+     * Clears the histogram
+     */
+    void reset();
+
+    /**
+     * Functions: getCount, getAverage, getMax
+     * @return The number of latencies recorded, and their average and maximum
+     * in microseconds
+     */
+    std::uint32_t getCount();
+    std::uint32_t getAverage();
+    std::uint32_t getMax();
+
+    /**
+     * Function: print
+     * Prints the histogram to the terminal
+     *
+     * @param name The name to print the histogram under
+     */
+    void print(const char* name);
+};
+
+#endif /* LatencyHistogram.hpp */
@@ -0,0 +1,84 @@
+#ifndef MECHANISM_HPP
+#define MECHANISM_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "api.h"
+
+/**
+ * \file Mechanism.hpp
+ *
+ * The Mechanism class is the base of every subsystem with background work to
+ * do, such as running a position controller or tracking odometry. That work
+ * goes in periodic, which is called every period milliseconds - by a Scheduler
+ * if the mechanism has been added to one, or otherwise by a task the mechanism
+ * starts for itself the first time it needs one.
+ */
+class Mechanism {
+   private:
+    // The name of the mechanism, used for its task and for Scheduler stats
+    const char* name;
+
+    // The time between calls to periodic, in milliseconds
+    std::uint32_t period;
+
+    /**
+     * Whether a Scheduler is calling periodic. Once set, the mechanism's own
+     * task (if it has one) stops, so periodic is never called from two places
+     * at once for long.
+     */
+    std::atomic<bool> scheduled{false};
+    pros::Task* periodicTask = NULL;
+
+    friend class Scheduler;
+
+   protected:
+    /**
+     * The constructor for the Mechanism class
+     *
+     * @param name The name of the mechanism
+     * @param period The time between calls to periodic, in milliseconds
+     */
+    Mechanism(const char* name, std::uint32_t period);
+
+    /**
+     * Function: setPeriod
+     * Changes the time between calls to periodic. Takes effect on the next
+     * call
+     *
+     * @param period The time between calls to periodic, in milliseconds
+     */
+    void setPeriod(std::uint32_t period);
+
+    /**
+     * Function: startPeriodic
+     * Makes sure periodic is being called. If the mechanism hasn't been added
+     * to a Scheduler, and hasn't started its own task yet, this starts one.
+     */
+    void startPeriodic();
+
+   public:
+    virtual ~Mechanism() {}
+
+    /**
+     * Function: periodic
+     * Does one cycle of the mechanism's background work. Must not block, as
+     * a Scheduler calls every mechanism from the same task.
+     */
+    virtual void periodic() = 0;
+
+    /**
+     * Function: getName
+     * @return The name of the mechanism
+     */
+    const char* getName();
+
+    /**
+     * Function: getPeriod
+     * @return The time between calls to periodic, in milliseconds
+     */
+    std::uint32_t getPeriod();
+};
+
+#endif /* Mechanism.hpp */
@@ -10,6 +10,7 @@
 #ifndef MOTORGROUP_HPP
 #define MOTORGROUP_HPP
 
+#include <functional>
 #include <initializer_list>
 #include <vector>
 
@@ -125,6 +126,16 @@ class MotorGroup {
      */
     void setGearing(pros::motor_gearset_e_t gearing);
 
+    /**
+     * Function: setCurrentLimit
+     * This function sets the current limit for all of the motors.
+     * It calls the motor_set_current_limit function on each motor
+     *
+     * @param limit The new current limit for each motor, in mA (2500 mA is the
+     * default and the maximum)
+     */
+    void setCurrentLimit(int limit);
+
     /**-------------------
      * Telemetry Functions
      *--------------------*/
@@ -137,11 +148,82 @@ class MotorGroup {
      */
     double getPosition();
 
+    /**
+     * Function getVelocity
+     * This function returns the average actual velocity of every motor in the
+     * group, as measured by the motors themselves
+     *
+     * @returns The average velocity of the motors, in RPM
+     */
+    double getVelocity();
+
+    /**
+     * Function getMaxVelocity
+     * This function returns the top speed of the motors in the group, based on
+     * the gear cartridge the motors are configured with. All motors in a group
+     * are assumed to share a cartridge, so only the first motor is checked
+     *
+     * @returns The maximum velocity of the motors, in RPM
+     */
+    int getMaxVelocity();
+
+    /**
+     * Function getTemperature
+     * This function returns the temperature of the hottest motor in the group
+     *
+     * @returns The highest motor temperature, in degrees Celsius
+     */
+    double getTemperature();
+
+    /**
+     * Function getCurrentDraw
+     * This function returns the average current drawn by the motors in the
+     * group
+     *
+     * @returns The average current draw, in mA
+     */
+    double getCurrentDraw();
+
+    /**
+     * Function isStalled
+     * This function checks whether the motors are stalled: drawing a lot of
+     * current while barely moving, such as when pushed into a hard stop or
+     * clamped on an object
+     *
+     * @param currentThreshold The average current draw, in mA, above which the
+     * motors could be stalled
+     * @param velocityThreshold The average speed, in RPM, below which the
+     * motors could be stalled
+     * @returns Whether the current draw is above currentThreshold and the speed
+     * is below velocityThreshold
+     */
+    bool isStalled(double currentThreshold, double velocityThreshold);
+
     /**
      * Function resetPosition
      * This function resets the position of the internal motor encoders
      */
     void resetPosition();
+
+    /**
+     * Function homeToStop
+     * This function drives the motors into a hard stop, detects the stall from
+     * their current draw and velocity, and zeroes the motor encoders there.
+     * Blocks until the stall is found or the timeout runs out
+     *
+     * @param velocity The velocity to drive at, in RPM (the sign gives the
+     * direction of the hard stop)
+     * @param currentThreshold The current draw, in mA, that indicates the
+     * motors have reached the hard stop (along with barely moving)
+     * @param timeout How long to try before giving up, in milliseconds
+     * @param cancel Checked every cycle - if it returns true, homing stops
+     * early without finding the hard stop. Defaults to never cancelling
+     * @returns Whether the hard stop was found. If not, the encoders are left
+     * alone
+     */
+    bool homeToStop(int velocity, double currentThreshold,
+                    std::uint32_t timeout,
+                    const std::function<bool()>& cancel = nullptr);
 };
 
 #endif /* MotorGroup.hpp */
\ No newline at end of file
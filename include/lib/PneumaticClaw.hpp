@@ -2,8 +2,12 @@
 #define PNEUMATICCLAW_HPP
 
 #include "api.h"
+#include "lib/ControllerScreen.hpp"
+#include "lib/ControllerState.hpp"
+#include "lib/LatencyHistogram.hpp"
+#include "lib/Mechanism.hpp"
 
-class PneumaticClaw {
+class PneumaticClaw : public Mechanism {
    private:
     /* The port in which the pneumatic solenoid (the part of a pneumatic system
      * that controls air flow) is plugged into in the brain. Can range between
@@ -17,12 +21,101 @@ class PneumaticClaw {
     bool closed;
 
     /**
-     * Counts how many cycles the button to toggle the claw has been pressed for
-     * in driver control. This is useful to prevent the claw from opening and
-     * then immediately closing, which is caused by the button to control the
-     * claw being held for 2 clock cycles
+     * The minimum time, in milliseconds, between toggles of the claw in driver
+     * control, and the time of the last toggle. Toggles happen on the first
+     * cycle a button is pressed, so this only guards against switch bounce and
+     * accidental double presses.
      */
-    int pressedCount = 0;
+    std::uint32_t minToggleInterval = 100;
+    std::uint32_t lastToggleTime = 0;
+
+    /**
+     * The time, in milliseconds, between writing to the solenoid and the claw
+     * finishing its movement, for closing (extending) and opening (retracting)
+     * the cylinder. Used to fire the solenoid early so the claw finishes
+     * moving at a planned time.
+     */
+    std::uint32_t closeLatency = 0;
+    std::uint32_t openLatency = 0;
+
+    /**
+     * The scheduled actuation, if any. scheduled is true while an actuation is
+     * waiting for fireTime (from pros::millis) to come around, and
+     * scheduledClose is whether it is a close (true) or open (false).
+     * periodic checks on it every 2 ms. scheduleMutex keeps the state
+     * consistent between periodic and the scheduling functions.
+     */
+    bool scheduled = false;
+    bool scheduledClose = false;
+    std::uint32_t fireTime = 0;
+    pros::Mutex scheduleMutex;
+
+    /**
+     * Air accounting. Each actuation fills one side of the cylinders
+     * (cylinderVolume, in cubic inches) from the tank (tankVolume, in cubic
+     * inches). By Boyle's law, this drops the tank's gauge pressure by a
+     * factor of tankVolume / (tankVolume + cylinderVolume). pressure is the
+     * modeled gauge pressure in psi, and the claw is out of air once it drops
+     * below minPressure. Accounting is off while tankVolume is 0.
+     */
+    double tankVolume = 0;
+    double cylinderVolume = 0;
+    double pressure = 0;
+    double minPressure = 0;
+
+    /**
+     * An optional analog pressure transducer. sensorPort is 0 if there isn't
+     * one, and sensorMaxPressure is the pressure read at the top of its
+     * output range.
+     */
+    char sensorPort = 0;
+    double sensorMaxPressure = 0;
+
+    /**
+     * The number of actuations kept in reserve for late-match grabs, the
+     * number of remaining actuations at which to warn the driver, and whether
+     * the driver has been warned yet.
+     */
+    int reserveActuations = 0;
+    int warningActuations = 0;
+    bool warned = false;
+
+    // The time from each controller snapshot to the solenoid write it caused
+    LatencyHistogram inputLatency;
+
+    // The controller screen to show the claw's state on, and the line to use
+    ControllerScreen* screen = NULL;
+    int screenLine = 0;
+
+    /**
+     * Function: postState
+     * Posts whether the claw is closed, and the actuations left if air
+     * accounting is set up, to the controller screen (if there is one)
+     */
+    void postState();
+
+    /**
+     * Function: useAir
+     * Takes one actuation's worth of air out of the modeled tank pressure
+     */
+    void useAir();
+
+    /**
+     * Function: schedule
+     * Schedules an actuation to finish at a given time
+     *
+     * @param close Whether to close (true) or open (false) the claw
+     * @param finishTime The time the claw should finish moving, in milliseconds
+     * since the program started (the same as pros::millis)
+     */
+    void schedule(bool close, std::uint32_t finishTime);
+
+    /**
+     * Function: updateSchedule
+     * Fires the scheduled actuation once its time has come. Called by
+     * periodic.
+     */
+    void updateSchedule();
 
    public:
     /**
@@ -35,14 +128,109 @@ class PneumaticClaw {
      */
     PneumaticClaw(char port, bool initPosition);
 
+    /**
+     * Function: periodic
+     * Fires scheduled actuations. Called every 2 ms by a Scheduler, or by the
+     * claw's own task once an actuation has been scheduled
+     */
+    void periodic() override;
+
+    /**
+     * Function: setMinToggleInterval
+     * Sets the minimum time between toggles of the claw in driver control
+     *
+     * @param milliseconds The minimum time between toggles, in milliseconds
+     */
+    void setMinToggleInterval(std::uint32_t milliseconds);
+
+    /**
+     * Function: setLatency
+     * Sets the time the claw takes to finish moving after the solenoid is
+     * written to
+     *
+     * @param closeMs The time to close (extend), in milliseconds
+     * @param openMs The time to open (retract), in milliseconds
+     */
+    void setLatency(std::uint32_t closeMs, std::uint32_t openMs);
+
+    /**
+     * Function: calibrateLatency
+     * Measures and stores the claw's latency by closing and then opening it,
+     * timing how long a limit switch that the claw presses when closed takes
+     * to change state. Blocks for up to 2.5 seconds.
+     *
+     * @param switchPort The ADI port of the limit switch ('a' - 'h')
+     * @return Whether both movements were measured. If not, the stored
+     * latencies are left alone
+     */
+    bool calibrateLatency(char switchPort);
+
+    /**
+     * Function: setCylinders
+     * Sets the size of the cylinders the claw's solenoid drives, for air
+     * accounting
+     *
+     * @param bore The inside diameter of each cylinder, in inches
+     * @param stroke The stroke length of each cylinder, in inches
+     * @param count The number of cylinders on the solenoid
+     */
+    void setCylinders(double bore, double stroke, int count);
+
+    /**
+     * Function: setAirSupply
+     * Sets up air accounting, which estimates how many more times the claw can
+     * actuate before running out of air
+     *
+     * @param tankVolume The total volume of the air tanks, in cubic inches
+     * @param startPressure The pressure the tanks are filled to, in psi
+     * @param minPressure The lowest pressure the claw still works at, in psi
+     */
+    void setAirSupply(double tankVolume, double startPressure,
+                      double minPressure);
+
+    /**
+     * Function: setPressureSensor
+     * Adds an analog pressure transducer, which is read instead of the modeled
+     * pressure. The transducer is assumed to output 0.5 V at 0 psi and 4.5 V
+     * at maxPressure, like most 5 V transducers.
+     *
+     * @param port The ADI port the transducer is plugged into ('a' - 'h')
+     * @param maxPressure The pressure at the transducer's top output, in psi
+     */
+    void setPressureSensor(char port, double maxPressure);
+
+    /**
+     * Function: setAirReserve
+     * Sets how many actuations to keep for late-match grabs. Once only the
+     * reserve is left, the claw can still be closed in driver control, but not
+     * opened (as every open needs another close to grab again).
+     *
+     * @param reserve The number of actuations to keep in reserve
+     * @param warning The number of remaining actuations at which the
+     * controller rumbles to warn the driver
+     */
+    void setAirReserve(int reserve, int warning);
+
+    /**
+     * Function: setScreen
+     * Sets a controller screen to show the claw's state and remaining air on.
+     * The low air warning rumble also goes through the screen's queue
+     *
+     * @param controllerScreen The screen to post to
+     * @param line The line of the screen to use (0 - 2)
+     */
+    void setScreen(ControllerScreen* controllerScreen, int line);
+
     /**
      * Function: driver
-     * Used to control the claw in driver control.
+     * Used to control the claw in driver control. The claw toggles on the first
+     * cycle the button is pressed, as long as it hasn't toggled within the
+     * minimum toggle interval.
      *
-     * @param controller The controller ID representing the physical controller
+     * @param controller The snapshot of the controller for this tick
      * @param button The button ID on the controller used to toggle the claw
      */
-    void driver(pros::controller_id_e_t controller,
+    void driver(ControllerState& controller,
                 pros::controller_digital_e_t button);
     /**
      * Function: close
@@ -57,6 +245,54 @@ class PneumaticClaw {
      * If not, this function won't do anything
      */
     void open();
+
+    /**
+     * Function: isClosed
+     * @return Whether the claw is currently closed
+     */
+    bool isClosed();
+
+    /**
+     * Functions: getCloseLatency, getOpenLatency
+     * @return The time the claw takes to close/open after the solenoid is
+     * written to, in milliseconds
+     */
+    std::uint32_t getCloseLatency();
+    std::uint32_t getOpenLatency();
+
+    /**
+     * Function: getPressure
+     * @return The air pressure in the tanks, in psi - read from the pressure
+     * transducer if there is one, and modeled otherwise
+     */
+    double getPressure();
+
+    /**
+     * Function: getRemainingActuations
+     * @return The estimated number of actuations left before the pressure
+     * drops below the minimum, or -1 if air accounting isn't set up
+     */
+    int getRemainingActuations();
+
+    /**
+     * Functions: closeAt, openAt
+     * Schedule the claw to finish closing/opening at a given time, by firing
+     * the solenoid early by the claw's latency. Returns immediately. A new
+     * schedule (or a call to open/close) replaces any existing one. If the time
+     * is too soon for the latency, the solenoid fires right away.
+     *
+     * @param finishTime The time the claw should finish moving, in milliseconds
+     * since the program started (the same as pros::millis)
+     */
+    void closeAt(std::uint32_t finishTime);
+    void openAt(std::uint32_t finishTime);
+
+    /**
+     * Function: getInputLatency
+     * @return The histogram of times from a controller snapshot to the solenoid
+     * write it caused in driver control
+     */
+    LatencyHistogram& getInputLatency();
 };
 
 #endif /* PneumaticClaw.hpp */
\ No newline at end of file
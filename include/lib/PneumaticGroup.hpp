@@ -0,0 +1,111 @@
+#ifndef PNEUMATICGROUP_HPP
+#define PNEUMATICGROUP_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "api.h"
+
+/**
+ * \file PneumaticGroup.hpp
+ *
+ * The PneumaticGroup class drives a set of solenoids, plugged into either the
+ * brain's ADI ports or ADI expanders. Setting a solenoid only changes its
+ * stored (shadow) state, and update writes every solenoid that changed in one
+ * go. This lets several actuators fire in the same tick, and keeps solenoids
+ * that didn't change from sending anything over the smart ports.
+ */
+class PneumaticGroup {
+   private:
+    /**
+     * A single solenoid. smartPort is the port of the ADI expander it is
+     * plugged into (INTERNAL_ADI_PORT for the brain), and adiPort is its port
+     * on that expander ('a' - 'h'). state is the state it should be in, and
+     * written is the state last written to it.
+     */
+    struct Solenoid {
+        std::uint8_t smartPort;
+        char adiPort;
+        bool state;
+        bool written;
+    };
+
+    // All the solenoids in the group, indexed by the ids from addSolenoid
+    std::vector<Solenoid> solenoids;
+
+    // Keeps the shadow states consistent between update and the other
+    // functions
+    pros::Mutex mutex;
+
+    // The task running update, if startTask has been called
+    pros::Task* updateTask = NULL;
+
+   public:
+    /**
+     * Function: addSolenoid
+     * Adds a solenoid plugged into one of the brain's ADI ports, and writes
+     * its initial state
+     *
+     * @param port The ADI port of the solenoid ('a' - 'h')
+     * @param initState The state the solenoid starts in (true for extended)
+     * @return The id of the solenoid, used by the other functions
+     */
+    int addSolenoid(char port, bool initState = false);
+
+    /**
+     * Function: addSolenoid
+     * Adds a solenoid plugged into an ADI expander, and writes its initial
+     * state
+     *
+     * @param expanderPort The smart port of the ADI expander
+     * @param port The ADI port of the solenoid on the expander ('a' - 'h')
+     * @param initState The state the solenoid starts in (true for extended)
+     * @return The id of the solenoid, used by the other functions
+     */
+    int addSolenoid(std::uint8_t expanderPort, char port,
+                    bool initState = false);
+
+    /**
+     * Function: set
+     * Sets the state of a solenoid. The solenoid is written to on the next
+     * update
+     *
+     * @param id The id of the solenoid, from addSolenoid
+     * @param state The new state of the solenoid (true for extended)
+     */
+    void set(int id, bool state);
+
+    /**
+     * Function: toggle
+     * Flips the state of a solenoid. The solenoid is written to on the next
+     * update
+     *
+     * @param id The id of the solenoid, from addSolenoid
+     */
+    void toggle(int id);
+
+    /**
+     * Function: get
+     * @param id The id of the solenoid, from addSolenoid
+     * @return The state of the solenoid, including changes not yet written
+     */
+    bool get(int id);
+
+    /**
+     * Function: update
+     * Writes every solenoid whose state has changed since the last update.
+     * Called every tick, either by the task from startTask or from a loop
+     * such as the opcontrol loop.
+     */
+    void update();
+
+    /**
+     * Function: startTask
+     * Starts a task that calls update periodically
+     *
+     * @param period The time between updates, in milliseconds
+     */
+    void startTask(std::uint32_t period = 10);
+};
+
+#endif /* PneumaticGroup.hpp */
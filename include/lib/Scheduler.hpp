@@ -0,0 +1,94 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "api.h"
+#include "lib/Mechanism.hpp"
+
+/**
+ * \file Scheduler.hpp
+ *
+ * The Scheduler class calls periodic on every mechanism added to it, at each
+ * mechanism's own period, from a single task. Mechanisms due in the same tick
+ * run in priority order. The time each periodic call takes is measured, so a
+ * mechanism that is slowing the others down is easy to find.
+ */
+
+/**
+ * Execution time stats for a mechanism, in microseconds. overruns is the
+ * number of times the mechanism was called late by a full period or more.
+ */
+struct MechanismStats {
+    std::uint32_t runs = 0;
+    std::uint32_t averageTime = 0;
+    std::uint32_t maxTime = 0;
+    std::uint32_t overruns = 0;
+};
+
+class Scheduler {
+   private:
+    /**
+     * A mechanism added to the scheduler. id is the id returned by add,
+     * nextRun is the time of its next call (from pros::millis), and totalTime
+     * is the total time spent in periodic, in microseconds.
+     */
+    struct Entry {
+        int id;
+        Mechanism* mechanism;
+        int priority;
+        std::uint32_t nextRun;
+        std::uint64_t totalTime;
+        MechanismStats stats;
+    };
+
+    // The mechanisms, sorted from highest to lowest priority
+    std::vector<Entry> entries;
+
+    // Keeps the entries consistent between the scheduler task and add
+    pros::Mutex mutex;
+    pros::Task* task = NULL;
+
+    /**
+     * Function: tick
+     * Calls periodic on every mechanism that is due. Called by the scheduler
+     * task every millisecond.
+     */
+    void tick();
+
+   public:
+    /**
+     * Function: add
+     * Adds a mechanism to the scheduler, which then calls its periodic
+     * function every period (from Mechanism::getPeriod). Should be called in
+     * initialize, before the mechanism is used.
+     *
+     * @param mechanism The mechanism to add
+     * @param priority Mechanisms with higher priorities run first when several
+     * are due in the same tick
+     * @return The id of the mechanism, for getStats
+     */
+    int add(Mechanism* mechanism, int priority = 0);
+
+    /**
+     * Function: start
+     * Starts the scheduler task, if it hasn't been started already
+     */
+    void start();
+
+    /**
+     * Function: getStats
+     * @param id The id of the mechanism, from add
+     * @return The execution time stats of the mechanism
+     */
+    MechanismStats getStats(int id);
+
+    /**
+     * Function: printStats
+     * Prints the execution time stats of every mechanism to the terminal
+     */
+    void printStats();
+};
+
+#endif /* Scheduler.hpp */
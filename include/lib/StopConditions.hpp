@@ -0,0 +1,51 @@
+#ifndef STOPCONDITIONS_HPP
+#define STOPCONDITIONS_HPP
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * \file StopConditions.hpp
+ *
+ * The StopCondition namespace holds functions that create stop conditions for
+ * sensor-terminated movements, such as TankDrive::moveStraightUntil. Each
+ * function returns a predicate that is checked every control cycle, and
+ * returns true once the movement should end.
+ */
+
+namespace StopCondition {
+/**
+ * Creates a stop condition that is met when a V5 distance sensor sees an
+ * object closer than a given distance.
+ *
+ * @param port: the smart port the distance sensor is plugged into
+ * @param millimeters: the distance, in millimeters, at which to stop
+ *
+ * @return A predicate that returns true once an object is within range
+ */
+std::function<bool()> distanceBelow(std::uint8_t port, int millimeters);
+
+/**
+ * Creates a stop condition that is met when an ADI limit switch or bumper is
+ * pressed. Configures the port as a digital input.
+ *
+ * @param port: the ADI port the switch is plugged into ('a' - 'h')
+ *
+ * @return A predicate that returns true while the switch is pressed
+ */
+std::function<bool()> switchPressed(char port);
+
+/**
+ * Creates a stop condition that is met when an ADI line tracker crosses a
+ * line. Line trackers read lower values over lighter surfaces, so the
+ * condition is met once the reading drops below the threshold.
+ *
+ * @param port: the ADI port the line tracker is plugged into ('a' - 'h')
+ * @param threshold: the reading (0 - 4095) below which a line is seen
+ *
+ * @return A predicate that returns true while the line tracker sees a line
+ */
+std::function<bool()> lineDetected(char port, int threshold);
+}  // namespace StopCondition
+
+#endif /* StopConditions.hpp */
@@ -1,10 +1,17 @@
 #ifndef TANKDRIVE_HPP
 #define TANKDRIVE_HPP
 
+#include <functional>
 #include <initializer_list>
 
 #include "api.h"
+#include "lib/ControllerScreen.hpp"
+#include "lib/ControllerState.hpp"
+#include "lib/FourBar.hpp"
+#include "lib/LatencyHistogram.hpp"
+#include "lib/Mechanism.hpp"
 #include "lib/MotorGroup.hpp"
+#include "lib/PneumaticClaw.hpp"
 
 /**
  * \file TankDrive.hpp
@@ -12,7 +19,27 @@
  * The TankDrive class is used to abstract the motors and (optionally)
  * ADI quadrature encoders on the drivetrain.
  */
-class TankDrive {
+
+/**
+ * The position and heading of the robot on the field. x and y are in inches,
+ * while theta is the heading in degrees, measured clockwise from the +y axis
+ * (the direction the robot faces when its pose is set to 0, 0, 0). Headings are
+ * kept between -180 and 180 degrees.
+ */
+struct Pose {
+    double x = 0;
+    double y = 0;
+    double theta = 0;
+};
+
+/**
+ * The payload the drivetrain is carrying. Carrying a mobile goal nearly
+ * doubles the mass of the robot, so the drivetrain keeps separate PID and
+ * feedforward constants for each payload.
+ */
+enum class Payload { empty, goal };
+
+class TankDrive : public Mechanism {
    private:
     /**
      * The MotorGroups representing each group of motors on the drivetrain.
@@ -23,12 +50,65 @@ class TankDrive {
      * The constants for the drivetrain's PID controller.
      * kP is the proportional constant, kI is the integral constant, and kD is
      * the derivative constant.
+     */
+    struct PIDConstants {
+        double kP = 0, kI = 0, kD = 0;
+    };
+
+    /**
+     * The PID constants for each payload, indexed by the Payload enum. The
+     * straight constants are for straight movement, while the turn constants
+     * are for turning.
      *
-     * The straight constants are for straight movement, while the turn
-     * constants are for turning
+     * kS is the static feedforward for each payload: the voltage (in
+     * millivolts) needed to get the drive moving, which is added to the output
+     * in the direction of motion.
      */
-    double kP_straight, kI_straight, kD_straight;
-    double kP_turn, kI_turn, kD_turn;
+    PIDConstants straightConstants[2], turnConstants[2];
+    double kS[2] = {0, 0};
+
+    /**
+     * Payload detection state. The current payload selects which constants
+     * are used. It is switched automatically from the claw's state (if
+     * payloadClaw is not NULL) and/or from the acceleration per volt measured
+     * at the start of each movement (if payloadAccelThreshold is above 0).
+     * Below the threshold (in RPM per second per volt), the robot is
+     * considered to be carrying a goal.
+     */
+    Payload payload = Payload::empty;
+    PneumaticClaw* payloadClaw = NULL;
+    double payloadAccelThreshold = 0;
+
+    /**
+     * The state of the acceleration per volt measurement for the current
+     * movement: the number of cycles measured, the sum of the voltages sent,
+     * and the drive's speed at the start of the movement. lastAccelPerVolt is
+     * the latest measurement, kept for tuning the detection threshold.
+     */
+    int estimateCycles = 0;
+    double estimateVoltSum = 0;
+    double estimateStartVelocity = 0;
+    double lastAccelPerVolt = 0;
+
+    /**
+     * Function: startMovement
+     * Called at the start of each autonomous movement. Updates the payload
+     * from the claw, starts a new acceleration per volt measurement and
+     * forgets slips from before the movement.
+     */
+    void startMovement();
+
+    /**
+     * Function: estimatePayload
+     * Called each cycle of an autonomous movement. For the first 20 cycles
+     * (100 ms), while the voltage ramps up, the voltage sent and the change in
+     * speed are recorded. After that, the acceleration per volt decides the
+     * payload for the rest of the movement.
+     *
+     * @param leftOutput The voltage sent to the left side this cycle
+     * @param rightOutput The voltage sent to the right side this cycle
+     */
+    void estimatePayload(double leftOutput, double rightOutput);
 
     /**
      * A variable used to store the radius of the wheels on the drivetrain.
@@ -55,6 +135,273 @@ class TankDrive {
     pros::ADIEncoder* leftEncoder = NULL;
     pros::ADIEncoder* rightEncoder = NULL;
 
+    /**
+     * The maximum amount that the output to each side of the drive (on the
+     * -127 to 127 scale) can change by per millisecond. Full stick step
+     * inputs otherwise go straight to the motors, which breaks the wheels loose
+     * and wastes traction. A value of 0 disables slew rate limiting.
+     */
+    double driverSlewRate = 0;
+
+    /**
+     * Traction control settings. When enabled, the measured acceleration of
+     * each side's wheels is compared against maxWheelAccel, the fastest the
+     * wheels can physically accelerate (in RPM per second) while still gripping
+     * the field. A wheel accelerating faster than that is spinning out, so the
+     * output to that side is clamped to just above its measured speed.
+     *
+     * tractionHeadroom is how far above the measured speed (on the -127 to 127
+     * scale) the clamped output is allowed to be, so the robot can still build
+     * up speed while slipping.
+     *
+     * With slew rate limiting on, the limit is raised to the acceleration the
+     * slew rate ramps the output at, if that is faster, so maxWheelAccel only
+     * needs to cover what the wheels can do on their own.
+     */
+    bool tractionControl = false;
+    double maxWheelAccel = 0;
+    int tractionHeadroom = 15;
+
+    /**
+     * The outputs sent to each side of the drive in the previous call of
+     * driver, along with the measured velocity of each side and the time they
+     * were measured at. Used for slew rate limiting and traction control.
+     */
+    int leftDriverOutput = 0, rightDriverOutput = 0;
+    double leftPrevVelocity = 0, rightPrevVelocity = 0;
+    std::uint32_t prevDriverTime = 0;
+
+    /**
+     * Function: limitDriverOutput
+     * Applies slew rate limiting and traction control to a joystick input for
+     * one side of the drivetrain.
+     *
+     * @param input The joystick value for the side, from -127 to 127
+     * @param prevOutput The output sent to the side on the previous cycle. It
+     * is updated to the new output
+     * @param prevVelocity The measured velocity of the side on the previous
+     * cycle, in RPM. It is updated to the current velocity
+     * @param motors The MotorGroup for the side
+     * @param dt The time since the previous cycle, in milliseconds
+     *
+     * @return The output to send to the side, from -127 to 127
+     */
+    int limitDriverOutput(int input, int& prevOutput, double& prevVelocity,
+                          MotorGroup& motors, std::uint32_t dt,
+                          bool slipping);
+
+    /**
+     * Slip detection settings. With ADI encoders added, the drivetrain has two
+     * independent measures of distance travelled: the unpowered tracking
+     * wheels and the integrated motor encoders. The motor encoders are
+     * converted into distance using the radius of the powered wheels and the
+     * external gear ratio between the motors and those wheels.
+     *
+     * Every slipWindow milliseconds, the distance each source reports for each
+     * side is compared. If they disagree by more than slipThreshold inches, the
+     * powered wheels are spinning (or skidding) relative to the field.
+     * A slipThreshold of 0 disables slip detection.
+     */
+    double driveWheelRadius = 0;
+    double driveGearRatio = 1.0;
+    double slipThreshold = 0;
+    std::uint32_t slipWindow = 100;
+
+    /**
+     * Slip detection state. The start values are the readings of each distance
+     * source (in degrees) at the start of the current window. The slipping
+     * flags hold the result of the latest window for each side.
+     */
+    double leftMotorStart = 0, rightMotorStart = 0;
+    double leftTrackStart = 0, rightTrackStart = 0;
+    std::uint32_t slipWindowStart = 0;
+    bool leftSlipping = false, rightSlipping = false;
+
+    /**
+     * Slip telemetry. slipCount is the number of windows in which slip was
+     * detected, while lastSlip is the magnitude, in inches, of the latest
+     * detected slip
+     */
+    int slipCount = 0;
+    double lastSlip = 0;
+
+    // The slip count when rampVoltCap last backed off, so that each detected
+    // slip only backs the voltage cap off once
+    int voltCapSlipCount = 0;
+
+    /**
+     * Function: updateSlip
+     * Compares the tracking wheels against the motor encoders once the current
+     * slip window has elapsed, updating the slipping flags and telemetry. Does
+     * nothing if slip detection is not configured.
+     */
+    void updateSlip();
+
+    /**
+     * Function: resetSlipWindow
+     * Starts a new slip window from the current sensor readings. Called when
+     * the sensors are reset so that the reset isn't mistaken for slip.
+     */
+    void resetSlipWindow();
+
+    /**
+     * Acceleration limits for the autonomous controllers. maxAccelStep is how
+     * much the voltage cap rises each controller cycle (in millivolts), and
+     * maxDecelStep is how much the output to either side can drop each cycle.
+     * By default, deceleration is not limited.
+     */
+    double maxAccelStep = 600;
+    double maxDecelStep = 12000;
+
+    /**
+     * Tip-over model. Raising the four bar lift (especially with a mobile goal)
+     * raises the robot's center of mass, and the acceleration a robot can take
+     * without tipping is proportional to (half its wheelbase) / (height of its
+     * center of mass). The center of mass is modelled as rising linearly from
+     * comHeightDown with the lift at 0 degrees to comHeightUp with the lift at
+     * liftRange degrees. All acceleration limits are scaled down by the
+     * resulting ratio. lift is NULL when the model is not in use.
+     */
+    FourBar* lift = NULL;
+    double comHeightDown = 1, comHeightUp = 1, liftRange = 1;
+
+    /**
+     * Function: getTipScale
+     * Uses the tip-over model and the current lift angle to find how much the
+     * acceleration limits need to be scaled down by
+     *
+     * @return The scale for the acceleration limits, between 0 and 1. 1 if no
+     * tip-over model is configured
+     */
+    double getTipScale();
+
+    /**
+     * Function: limitDecel
+     * Limits how much the output to one side of the drive can drop (or reverse)
+     * in one controller cycle, based on maxDecelStep and the tip-over model
+     *
+     * @param output The desired output for the side, in millivolts
+     * @param prevOutput The output sent on the previous cycle. It is updated to
+     * the new output
+     * @return The output to send to the side, in millivolts
+     */
+    double limitDecel(double output, double& prevOutput);
+
+    /**
+     * Function: rampDown
+     * Smoothly brings both sides of the drive to a stop from the given
+     * outputs, rather than stopping instantly. The outputs drop by (at most)
+     * 1200 mV every 5 ms, scaled down by the tip-over model, but never by less
+     * than 100 mV.
+     *
+     * @param leftOutput The current output of the left side, in millivolts
+     * @param rightOutput The current output of the right side, in millivolts
+     */
+    void rampDown(double leftOutput, double rightOutput);
+
+    /**
+     * Function: rampVoltCap
+     * Raises the voltage cap used by the autonomous controllers by one step,
+     * or backs it off if the wheels are slipping. Called once per controller
+     * cycle.
+     *
+     * @param voltCap The current voltage cap, in millivolts
+     * @return The voltage cap for this cycle, in millivolts
+     */
+    double rampVoltCap(double voltCap);
+
+    /**
+     * Odometry state. The pose is the robot's position on the field, updated
+     * by periodic from the change in each side's position sensor since the
+     * previous update (odomPrevLeft and odomPrevRight, in degrees).
+     * odometryRunning is true once startOdometry has been called. odomMutex
+     * keeps the pose and previous readings consistent between periodic and
+     * everything else.
+     */
+    Pose pose;
+    double odomPrevLeft = 0, odomPrevRight = 0;
+    bool odometryRunning = false;
+    pros::Mutex odomMutex;
+
+    // The time from each controller snapshot to the motor write it caused
+    LatencyHistogram inputLatency;
+
+    /**
+     * The controller screen to show the drive motors' temperature on, the
+     * line to use, and when it was last posted (from pros::millis)
+     */
+    ControllerScreen* screen = NULL;
+    int screenLine = 0;
+    std::uint32_t lastScreenPost = 0;
+
+    /**
+     * Vision assist settings. While the assist button is held in driver
+     * control, the drive turns to center the largest object matching
+     * visionSignature on the vision sensor in visionPort (0 if there isn't
+     * one). The turn is visionKP times the object's distance from the center
+     * of the image, in pixels, capped at visionMaxTurn.
+     */
+    std::uint8_t visionPort = 0;
+    std::uint8_t visionSignature = 0;
+    double visionKP = 0;
+    int visionMaxTurn = 0;
+
+    /**
+     * The last vision reading: the target's distance from the center of the
+     * image (in pixels, positive to the right), whether a target was seen,
+     * and when it was read (from pros::millis). The sensor only takes a new
+     * image every 20 ms, so a reading is reused until the next one is ready.
+     */
+    int visionOffset = 0;
+    bool visionTarget = false;
+    bool visionRead = false;
+    std::uint32_t lastVisionRead = 0;
+
+    /**
+     * Function: getVisionTurn
+     * Reads the vision sensor, if a new image is ready, and finds the turn
+     * needed to center the target
+     *
+     * @return The turn correction, as a joystick value (positive turns right),
+     * or 0 if no target is seen
+     */
+    int getVisionTurn();
+
+    /**
+     * Function: driveSides
+     * Sends the driver's output for each side through slew rate limiting and
+     * traction control to the motors. Shared by both driver functions.
+     *
+     * @param controller The snapshot of the controller the outputs came from
+     * @param left The output for the left side, as a joystick value
+     * @param right The output for the right side, as a joystick value
+     */
+    void driveSides(ControllerState& controller, int left, int right);
+
+    /**
+     * Function: updateOdometry
+     * Updates the pose from the distance each side has travelled since the
+     * last update. Called by periodic.
+     */
+    void updateOdometry();
+
+    /**
+     * Functions: readLeftPosition, readRightPosition
+     * Read the position of each side from whichever sensor the drivetrain
+     * tracks position with, in degrees. Unlike getLeftPosition and
+     * getRightPosition, these don't print the value, as odometry calls them
+     * every cycle.
+     */
+    double readLeftPosition();
+    double readRightPosition();
+
+    /**
+     * Function: wrapAngle
+     * @param angle An angle, in degrees
+     * @return The equivalent angle between -180 and 180 degrees
+     */
+    static double wrapAngle(double angle);
+
     /**
      * Function: drivePID
      * This function contains the actual PID controller used to control the
@@ -73,15 +420,25 @@ class TankDrive {
      * @param rightTarg: The target length to move to, in inches, for the
      * right side of the drivetrain Can be negative to indicate rotating
      * backwards
-     * @param kP: the value of the proportional constant to use in the PID
-     * controller
-     * @param kI: the value of the integral constant to use  in the PID
-     * controller
-     * @param kD: the value of the derivative constant to use  in the PID
-     * controller
+     * @param turning: whether the movement is a turn, which determines whether
+     * the straight or turn PID constants for the current payload are used
+     * @param until: an optional stop condition, checked every cycle. If it is
+     * met, the movement ends early and the drive decelerates smoothly to a stop
+     * @param onTrigger: an optional function called the moment the stop
+     * condition is met, before decelerating (e.g. closing the claw)
+     * @param leadTime: how long before the drive is predicted to arrive at
+     * its target to call onLead, in milliseconds
+     * @param onLead: an optional function called once, leadTime milliseconds
+     * before the drive is predicted to arrive (or on arrival, if the
+     * prediction never gets there first)
+     *
+     * @return Whether the movement was ended by the stop condition
      */
-    void drivePID(double leftTarg, double rightTarg, double kP, double kI,
-                  double kD);
+    bool drivePID(double leftTarg, double rightTarg, bool turning,
+                  const std::function<bool()>& until = nullptr,
+                  const std::function<void()>& onTrigger = nullptr,
+                  double leadTime = 0,
+                  const std::function<void()>& onLead = nullptr);
 
    public:
     /**
@@ -104,6 +461,13 @@ class TankDrive {
               std::initializer_list<bool> leftRevs,
               std::initializer_list<bool> rightRevs);
 
+    /**
+     * Function: periodic
+     * Updates odometry, once it has been started. Called every 10 ms by a
+     * Scheduler, or by the drivetrain's own task once odometry has started
+     */
+    void periodic() override;
+
     /*-------------------------
      * Configuration functions
      *-------------------------*/
@@ -120,7 +484,8 @@ class TankDrive {
     /**
      * Function: setPIDConstants
      * This function sets the PID constants of the drivetrain for moving
-     * straight.
+     * straight, for every payload. Call setPayloadPIDConstants afterwards to
+     * override the constants for a specific payload.
      *
      * @param Pconst: the value of the proportional constant in the PID
      * controller
@@ -131,7 +496,9 @@ class TankDrive {
 
     /**
      * Function: setPIDTurnConstants
-     * This function sets the PID constants of the drivetrain for turning.
+     * This function sets the PID constants of the drivetrain for turning, for
+     * every payload. Call setPayloadPIDTurnConstants afterwards to override the
+     * constants for a specific payload.
      *
      * @param Pconst: the value of the proportional constant in the PID
      * controller for turning
@@ -142,6 +509,66 @@ class TankDrive {
      */
     void setPIDTurnConstants(double Pconst, double Iconst, double Dconst);
 
+    /**
+     * Function: setPayloadPIDConstants
+     * This function sets the PID constants of the drivetrain for moving
+     * straight while carrying the given payload.
+     *
+     * @param load: the payload the constants are for
+     * @param Pconst: the value of the proportional constant
+     * @param Iconst: the value of the integral constant
+     * @param Dconst: the value of the derivative constant
+     */
+    void setPayloadPIDConstants(Payload load, double Pconst, double Iconst,
+                                double Dconst);
+
+    /**
+     * Function: setPayloadPIDTurnConstants
+     * This function sets the PID constants of the drivetrain for turning while
+     * carrying the given payload.
+     *
+     * @param load: the payload the constants are for
+     * @param Pconst: the value of the proportional constant
+     * @param Iconst: the value of the integral constant
+     * @param Dconst: the value of the derivative constant
+     */
+    void setPayloadPIDTurnConstants(Payload load, double Pconst, double Iconst,
+                                    double Dconst);
+
+    /**
+     * Function: setPayloadFeedforward
+     * This function sets the static feedforward used while carrying the given
+     * payload: the voltage needed to get the drive moving, added to the output
+     * in the direction of motion.
+     *
+     * @param load: the payload the feedforward is for
+     * @param staticVoltage: the feedforward voltage, in millivolts
+     */
+    void setPayloadFeedforward(Payload load, double staticVoltage);
+
+    /**
+     * Function: setPayloadDetection
+     * This function configures automatic payload switching. Both sources are
+     * optional; if both are used, the acceleration measurement overrides the
+     * claw once it has been taken.
+     *
+     * @param claw: a pointer to the claw. While it is closed, the drive is
+     * considered to be carrying a goal. NULL to not use the claw
+     * @param accelThreshold: the acceleration per volt (RPM per second per
+     * volt) measured at the start of each movement below which the drive is
+     * considered to be carrying a goal. 0 to not measure acceleration
+     */
+    void setPayloadDetection(PneumaticClaw* claw, double accelThreshold);
+
+    /**
+     * Function: setPayload
+     * This function manually sets the current payload. Automatic payload
+     * detection (if configured) may change it at the next movement.
+     *
+     * @param load: the payload the drive is carrying
+     */
+    void setPayload(Payload load);
+
     /**
      * Function: setDimensions
      * This function sets the dimensions of the drivetrain. These values are
@@ -176,6 +603,106 @@ class TankDrive {
     void addADIEncoders(char leftEncoderTopPort, bool leftEncoderRev,
                         char rightEncoderTopPort, bool rightEncoderRev);
 
+    /**
+     * Function: setDriverSlewRate
+     * This function limits how quickly the output to each side of the drive
+     * can change in driver control.
+     *
+     * @param maxChangePerMs The maximum change in output (on the -127 to 127
+     * scale) allowed per millisecond. 0 disables slew rate limiting
+     */
+    void setDriverSlewRate(double maxChangePerMs);
+
+    /**
+     * Function: setTractionControl
+     * This function configures traction control in driver control. When
+     * enabled, a side of the drive whose wheels accelerate faster than
+     * maxAccel is considered to be slipping, and its output is clamped to just
+     * above its measured speed until the wheels grip again.
+     *
+     * @param enabled Whether or not traction control is used
+     * @param maxAccel The maximum acceleration of the wheels, in RPM per
+     * second, before they are considered to be slipping. The driver slew rate
+     * (see setDriverSlewRate) raises this to match its own ramp
+     * @param headroom How far above the measured wheel speed (on the -127 to
+     * 127 scale) the output may be while slipping. Defaults to 15
+     */
+    void setTractionControl(bool enabled, double maxAccel, int headroom = 15);
+
+    /**
+     * Function: setSlipDetection
+     * This function configures slip detection, which cross-checks the ADI
+     * tracking wheels against the motor encoders. Requires addADIEncoders to
+     * have been called. Detected slip makes drivePID back off its voltage cap,
+     * and (with traction control enabled) clamps the output in driver control.
+     *
+     * @param driveWheelDiameter The diameter of the powered wheels, in inches
+     * @param gearRatio The external gear ratio between the motors and the
+     * powered wheels, input as (teeth on driving gear) / (teeth on driven gear)
+     * @param threshold The difference, in inches, between the two distance
+     * sources over one window that counts as slip. 0 disables slip detection
+     * @param window The length of each comparison window, in milliseconds.
+     * Defaults to 100
+     */
+    void setSlipDetection(double driveWheelDiameter, double gearRatio,
+                          double threshold, std::uint32_t window = 100);
+
+    /**
+     * Function: setAccelLimits
+     * This function sets the acceleration limits used in autonomous control.
+     *
+     * @param accelStep How much the voltage cap can rise each controller cycle
+     * (5 ms), in millivolts. Defaults to 600. The step used never drops below
+     * 100, so the drive can always get moving
+     * @param decelStep How much the output to either side can drop each
+     * controller cycle, in millivolts. Defaults to 12000 (unlimited)
+     */
+    void setAccelLimits(double accelStep, double decelStep);
+
+    /**
+     * Function: setTipModel
+     * This function configures the tip-over model, which scales down the
+     * acceleration and deceleration limits (both in autonomous and the slew
+     * rate in driver control) as the four bar lift raises the robot's center
+     * of mass.
+     *
+     * @param fourBar A pointer to the four bar lift
+     * @param heightDown The height of the robot's center of mass with the lift
+     * down, in inches
+     * @param heightUp The height of the robot's center of mass with the lift at
+     * range degrees, in inches
+     * @param range The angle of the lift (not the motors) at which the center
+     * of mass reaches heightUp, in degrees
+     */
+    void setTipModel(FourBar* fourBar, double heightDown, double heightUp,
+                     double range);
+
+    /**
+     * Function: setScreen
+     * This function sets a controller screen to show the temperature of the
+     * hottest drive motor on during driver control. It is posted once a
+     * second, at a higher priority once the motors are hot enough to start
+     * limiting their power (55 degrees C)
+     *
+     * @param controllerScreen The screen to post to
+     * @param line The line of the screen to use (0 - 2)
+     */
+    void setScreen(ControllerScreen* controllerScreen, int line);
+
+    /**
+     * Function: setVisionAssist
+     * This function configures vision assist, which turns the robot to line up
+     * with a mobile goal while the driver holds a button (see driver). Sets
+     * the vision sensor's zero point to the center of the image.
+     *
+     * @param port The port of the vision sensor
+     * @param signature The vision signature the goals are trained as (1 - 7)
+     * @param kP The turn correction per pixel the goal is off center
+     * @param maxTurn The largest turn correction, as a joystick value
+     */
+    void setVisionAssist(std::uint8_t port, std::uint8_t signature, double kP,
+                         int maxTurn);
+
     /*-------------------
      * Movement functions
      *-------------------*/
@@ -184,11 +711,29 @@ class TankDrive {
      * This function is used to control the drivetrain in driver control. It
      * uses a 2 joystick tank drive style of control, with the Y axes on
      * each joystick controlling their respective sides of the drive.
+     * The joystick values are passed through slew rate limiting and traction
+     * control (if configured) before reaching the motors.
+     *
+     * @param controller the snapshot of the controller to get joystick
+     * values from
+     */
+    void driver(ControllerState& controller);
+
+    /**
+     * Function: driver
+     * This implementation of the driver function adds vision assist. While
+     * the assist button is held, the robot turns to center the largest goal
+     * the vision sensor sees, and the driver controls forward speed with the
+     * average of the two joysticks. Otherwise (or if vision assist isn't
+     * configured), it drives like the tank drive function above.
      *
-     * @param controller the ID of the controller to get joystick values
-     * from
+     * @param controller the snapshot of the controller to get joystick
+     * values from
+     * @param assistButton The button on the controller held to line up with a
+     * goal
      */
-    void driver(pros::controller_id_e_t controller);
+    void driver(ControllerState& controller,
+                pros::controller_digital_e_t assistButton);
 
     /**
      * Function: moveStraight
@@ -200,6 +745,43 @@ class TankDrive {
      */
     void moveStraight(double distance);
 
+    /**
+     * Function: moveStraight
+     * This overload of moveStraight also runs an action a set time before the
+     * drive is predicted to arrive, based on the remaining distance and how
+     * quickly it is closing. Used to fire actuators with a known delay (such
+     * as PneumaticClaw::close, with PneumaticClaw::getCloseLatency) early, so
+     * they finish right as the drive arrives.
+     *
+     * @param distance: the distance to travel, in inches. Negative values =
+     * backwards
+     * @param leadTime: how long before arriving to run the action, in
+     * milliseconds
+     * @param action: the action to run
+     */
+    void moveStraight(double distance, double leadTime,
+                      const std::function<void()>& action);
+
+    /**
+     * Function: moveStraightUntil
+     * This function drives forward or backward until a stop condition is met,
+     * or a maximum distance has been travelled. The condition is checked every
+     * control cycle. Once it is met, onTrigger is called immediately and the
+     * drive decelerates smoothly to a stop. See StopConditions.hpp for
+     * conditions based on common sensors. Used in autonomous.
+     *
+     * @param maxDistance: the furthest to travel, in inches. Negative values =
+     * backwards
+     * @param condition: the stop condition
+     * @param onTrigger: an optional function to call the moment the condition
+     * is met, such as closing the claw on a goal
+     *
+     * @return Whether the condition was met before reaching maxDistance
+     */
+    bool moveStraightUntil(double maxDistance,
+                           const std::function<bool()>& condition,
+                           const std::function<void()>& onTrigger = nullptr);
+
     /**
      * Function: turnAngle
      * This function makes the drivetrain turn a given amount of degrees. Used
@@ -211,6 +793,77 @@ class TankDrive {
      */
     void turnAngle(double angle);
 
+    /**
+     * Function: driveToPoint
+     * This function drives the robot to a point on the field, correcting both
+     * the distance to the point and the heading towards it at the same time.
+     * Because the target is a field position rather than a relative distance,
+     * error left over from earlier movements is corrected. If the point is
+     * behind the robot, it backs up to it. Used in autonomous.
+     *
+     * Uses the straight PID constants for distance and the turn PID constants
+     * for heading.
+     *
+     * @param x: the x coordinate of the point, in inches
+     * @param y: the y coordinate of the point, in inches
+     * @param timeout: the longest the movement can take, in milliseconds.
+     * Defaults to 5000 (the movement also ends early if the drive stalls)
+     */
+    void driveToPoint(double x, double y, std::uint32_t timeout = 5000);
+
+    /**
+     * Function: turnToHeading
+     * This function turns the robot to face a heading on the field. Used in
+     * autonomous
+     *
+     * @param heading: the heading to face, in degrees clockwise from the +y
+     * axis
+     */
+    void turnToHeading(double heading);
+
+    /*--------------------
+     * Odometry Functions
+     *--------------------*/
+    /**
+     * Function: startOdometry
+     * Starts keeping track of the robot's pose on the field. Should be called
+     * in initialize. If it hasn't been called, driveToPoint and turnToHeading
+     * start it, treating wherever the robot is as the origin.
+     */
+    void startOdometry();
+
+    /**
+     * Function: setPose
+     * Sets the robot's current pose on the field, such as its starting
+     * position at the beginning of autonomous.
+     *
+     * @param x: the x coordinate of the robot, in inches
+     * @param y: the y coordinate of the robot, in inches
+     * @param theta: the heading of the robot, in degrees clockwise from the +y
+     * axis
+     */
+    void setPose(double x, double y, double theta);
+
+    /**
+     * Function: getPose
+     * @return The robot's current pose on the field
+     */
+    Pose getPose();
+
+    /**
+     * Function: getPayload
+     * @return The payload the drivetrain currently thinks it is carrying
+     */
+    Payload getPayload();
+
+    /**
+     * Function: getAccelPerVolt
+     * @return The acceleration per volt (RPM per second per volt) measured at
+     * the start of the latest autonomous movement, for tuning payload
+     * detection. 0 if nothing has been measured yet
+     */
+    double getAccelPerVolt();
+
     /*--------------------
      * Telemetry Functions
      *--------------------*/
@@ -240,6 +893,39 @@ class TankDrive {
      * is using to track its position in autonomous control.
      */
     void resetPositions();
+
+    /**
+     * Function: getSlipCount
+     * @return The number of slip events detected since the last call of
+     * resetSlipCount
+     */
+    int getSlipCount();
+
+    /**
+     * Function: getLastSlip
+     * @return The magnitude, in inches, of the most recent slip event
+     */
+    double getLastSlip();
+
+    /**
+     * Function: isSlipping
+     * @return Whether either side of the drivetrain slipped in the latest slip
+     * window
+     */
+    bool isSlipping();
+
+    /**
+     * Function: resetSlipCount
+     * Resets the slip event counter and last slip magnitude
+     */
+    void resetSlipCount();
+
+    /**
+     * Function: getInputLatency
+     * @return The histogram of times from a controller snapshot to the motor
+     * write it caused in driver control
+     */
+    LatencyHistogram& getInputLatency();
 };
 
 #endif /* TankDrive.hpp*/
\ No newline at end of file
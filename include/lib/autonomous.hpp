@@ -22,7 +22,8 @@ enum class Routine {
     sideGoal_WP,
     sideGoal_NoWP,
     middleGoal_WP,
-    skills
+    skills,
+    replay
 };
 
 }  // namespace Autonomous
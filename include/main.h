@@ -45,8 +45,18 @@
 // User Files
 #include "externs.hpp"
 #include "lib/Claw.hpp"
+#include "lib/Completion.hpp"
+#include "lib/ControllerArbiter.hpp"
+#include "lib/ControllerScreen.hpp"
+#include "lib/ControllerState.hpp"
 #include "lib/FourBar.hpp"
+#include "lib/InputRecorder.hpp"
+#include "lib/LatencyHistogram.hpp"
+#include "lib/Mechanism.hpp"
 #include "lib/MotorGroup.hpp"
+#include "lib/PneumaticGroup.hpp"
+#include "lib/Scheduler.hpp"
+#include "lib/StopConditions.hpp"
 #include "lib/TankDrive.hpp"
 #include "lib/autonomous.hpp"
 #include "lib/gui.hpp"
@@ -24,9 +24,15 @@ const char* Autonomous::buttonMatrixList[] = {"Skills",
                                               "Side Goal - No WP",
                                               "\n",
                                               "Middle Goal - WP",
+                                              "\n",
+                                              "Replay",
                                               ""};
 
 void autonomous() {
+    // Find the lift's zero position in the background, now that the motors
+    // can run. Lift movements wait for it
+    if (!lift.isHomed()) lift.homeAsync();
+
     switch (autonID) {
         case Autonomous::Routine::skills:
             // Skills Auton
@@ -81,8 +87,9 @@ void autonomous() {
             break;
         case Autonomous::Routine::sideGoal_NoWP:
             claw.open();
-            drive.moveStraight(50);
-            claw.close();
+            // Fire the claw early so it closes right as the robot arrives
+            drive.moveStraight(50, claw.getCloseLatency(),
+                               [] { claw.close(); });
             drive.moveStraight(-45);
             break;
         case Autonomous::Routine::middleGoal_WP:
@@ -127,6 +134,21 @@ void autonomous() {
             drive.turnAngle(90);
 
             break;
+        case Autonomous::Routine::replay: {
+            // Plays back a driver recording (copied to replay.bin on the SD
+            // card) through driver control, at the rate it was recorded. Both
+            // controllers are played back and arbitrated like they were live
+            ControllerArbiter replayed;
+            if (!recorder.startPlayback("/usd/replay.bin")) break;
+            std::uint32_t time = pros::millis();
+            while (recorder.play(replayed.getRaw(ControlSource::master),
+                                 replayed.getRaw(ControlSource::partner))) {
+                replayed.combine();
+                driverControl(replayed);
+                pros::Task::delay_until(&time, recorder.getTickPeriod());
+            }
+            break;
+        }
         case Autonomous::Routine::none:
         default:
             break;
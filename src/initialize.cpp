@@ -6,6 +6,10 @@ FourBar lift({10, 20}, {false, true});
 // Claw claw({9}, {false});
 PneumaticClaw claw('e', false);
 TankDrive drive({11, 12}, {4, 8}, {false, false}, {true, true});
+Scheduler scheduler;
+ControllerScreen masterScreen(CONTROLLER_MASTER);
+InputRecorder recorder;
+ControllerArbiter controllers;
 
 /**
  * Runs initialization code. This occurs as soon as the program is started.
@@ -31,11 +35,38 @@ lv_res_t goToAuton(lv_obj_t* btn);
 lv_res_t goToMain(lv_obj_t* btn);
 
 void initialize() {
+    // Every subsystem's background work runs from the scheduler. The drive's
+    // odometry comes first, as the other subsystems don't depend on timing as
+    // closely
+    scheduler.add(&drive, 2);
+    scheduler.add(&lift, 1);
+    scheduler.add(&claw, 0);
+    scheduler.start();
+
+    // Driver feedback on the controller screen
+    masterScreen.start();
+    claw.setScreen(&masterScreen, 0);
+    drive.setScreen(&masterScreen, 1);
+
+    // Telemetry printing runs below everything else
+    pros::Task(telemetry, TASK_PRIORITY_DEFAULT - 2, TASK_STACK_DEPTH_DEFAULT,
+               "Telemetry");
+
     // Configuring lift
     lift.setExternalGearRatio(12.0 / 60.0);
     lift.setGearing(MOTOR_GEARSET_18);
     lift.setMaxSpeeds(150, 80);
     lift.setHoldThreshold(20);
+    // The arms are horizontal about 45 degrees above their resting position
+    lift.setGravityCompensation(1500, 3000, 45, &claw);
+    lift.setHoldMode(HoldMode::active, 20, 800, 15);
+
+    // Configuring claw
+    // Two 200 mL (12.2 cubic inch) tanks filled to 100 psi; the claw stops
+    // gripping reliably below about 40 psi
+    claw.setCylinders(0.375, 2, 2);
+    claw.setAirSupply(24.4, 100, 40);
+    claw.setAirReserve(2, 6);
 
     // Configuring drive
     // Dimensions for encoder wheels
@@ -44,8 +75,25 @@ void initialize() {
     drive.setDimensions(3.25, 9.875);
     drive.setGearing(pros::E_MOTOR_GEARSET_18);
     // drive.addADIEncoders('g', false, 'a', false);
+    // Slip detection compares the encoder wheels against the drive wheels
+    // drive.setSlipDetection(3.25, 1.0, 0.5);
     drive.setPIDConstants(50, 0, 1);
     drive.setPIDTurnConstants(90, 0, 1);
+    // The robot is much heavier with a goal in the claw
+    drive.setPayloadPIDConstants(Payload::goal, 80, 0, 2);
+    drive.setPayloadPIDTurnConstants(Payload::goal, 140, 0, 2);
+    drive.setPayloadDetection(&claw, 0);
+    // Driver control acceleration limits. The slew rate is the 25 per 20 ms
+    // loop it was tuned at (full power in about 100 ms)
+    drive.setDriverSlewRate(1.25);
+    drive.setTractionControl(true, 1000);
+    drive.startOdometry();
+    // Center of mass rises from about 6 to 13 inches at full lift height
+    drive.setAccelLimits(600, 1200);
+    drive.setTipModel(&lift, 6, 13, 75);
+    // Goals are trained as signature 1 on the vision sensor in port 15. A goal
+    // at the edge of the image (158 pixels off) gets the full 40 turn
+    drive.setVisionAssist(15, 1, 0.25, 40);
 
     scrMain = lv_obj_create(NULL, NULL);
     scrAuton = lv_obj_create(NULL, NULL);
@@ -81,7 +129,10 @@ void initialize() {
  * or the VEX Competition Switch, following either autonomous or opcontrol.
  * When the robot is enabled, this task will exit.
  */
-void disabled() {}
+void disabled() {
+    // Finish writing any driver recording
+    recorder.stopRecording();
+}
 
 /**
  * Runs after initialize(), and before autonomous when connected to the
@@ -118,6 +169,9 @@ void updateAutonLbl() {
         case Autonomous::Routine::middleGoal_WP:
             lv_label_set_text(curAutonLbl, "Middle Goal - Win Point");
             break;
+        case Autonomous::Routine::replay:
+            lv_label_set_text(curAutonLbl, "Replay Driver Recording");
+            break;
         case Autonomous::Routine::none:
             lv_label_set_text(curAutonLbl, "No Auton Selected");
             break;
@@ -149,6 +203,9 @@ lv_res_t updateAutonID(lv_obj_t* btnm, const char* txt) {
     else if (txt == "Middle Goal - WP")
         autonID = Autonomous::Routine::middleGoal_WP;
 
+    else if (txt == "Replay")
+        autonID = Autonomous::Routine::replay;
+
     else
         autonID = Autonomous::Routine::none;
 
@@ -1,7 +1,7 @@
 #include "lib/Claw.hpp"
 
 Claw::Claw(std::initializer_list<int> ports, std::initializer_list<bool> revs)
-    : motors(ports, revs) {
+    : Mechanism("Claw", 5), motors(ports, revs) {
     // Encoders output their rotation in degrees (Other options don't really
     // make sense)
     motors.setEncoderUnits(pros::E_MOTOR_ENCODER_DEGREES);
@@ -15,35 +15,68 @@ void Claw::setMaxSpeed(int maxRPM) { maxSpd = maxRPM; }
 
 void Claw::setDigitalRotation(double degrees) { digitalRotation = degrees; }
 
-void Claw::driver(pros::controller_id_e_t controller,
+void Claw::setHoming(int speed, double current, std::uint32_t timeout) {
+    homingSpeed = speed;
+    homingCurrent = current;
+    homingTimeout = timeout;
+}
+
+void Claw::setGrip(double contact, int grip, std::uint32_t timeout) {
+    contactCurrent = contact;
+    gripCurrent = grip;
+    gripTimeout = timeout;
+}
+
+void Claw::driver(ControllerState& controller,
                   pros::controller_digital_e_t closeButton,
                   pros::controller_digital_e_t openButton) {
-    if (pros::c::controller_get_digital(controller, closeButton))
+    // The driver can't move the claw until homing is done
+    if (homing) return;
+
+    if (controller.getDigital(closeButton)) {
         close();
-    else if (pros::c::controller_get_digital(controller, openButton))
+        inputLatency.recordSince(controller.getTimestamp());
+    } else if (controller.getDigital(openButton)) {
         open();
+        inputLatency.recordSince(controller.getTimestamp());
+    }
 
-    else
+    // Stopping the motors would drop a grip from closeUntilGripped
+    else if (!gripping)
         motors.moveVelocity(0);
 }
 
-void Claw::driver(pros::controller_id_e_t controller,
+void Claw::driver(ControllerState& controller,
                   pros::controller_digital_e_t closeButton,
                   pros::controller_digital_e_t openButton,
                   pros::controller_digital_e_t digitalCloseButton,
                   pros::controller_digital_e_t digitalOpenButton) {
-    if (pros::c::controller_get_digital(controller, digitalCloseButton))
-        closeTo();
-    else if (pros::c::controller_get_digital(controller, digitalOpenButton))
-        openTo();
-
-    else
-        // If neither digital button is pressed, call the simpler driver
-        // function for analog control
+    if (homing) return;
+
+    /**
+     * The digital movements are started without waiting for them to finish,
+     * so the rest of the opcontrol loop isn't held up. They only start on a
+     * new press, as holding the button would otherwise restart the movement
+     * every cycle.
+     */
+    if (controller.getNewPress(digitalCloseButton)) {
+        closeToAsync();
+        inputLatency.recordSince(controller.getTimestamp());
+    } else if (controller.getNewPress(digitalOpenButton)) {
+        openToAsync();
+        inputLatency.recordSince(controller.getTimestamp());
+    }
+
+    // Analog control takes over from a digital movement if its buttons are
+    // pressed, but is otherwise left alone until the movement finishes
+    else if (controller.getDigital(closeButton) ||
+             controller.getDigital(openButton) || !isBusy())
         driver(controller, closeButton, openButton);
 }
 
 void Claw::open() {
+    cancelCommand();
+    releaseGrip();
     // If the claw is opening, holding position is not important. So, it's
     // better to not have the motors hold position
     motors.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
@@ -53,6 +86,8 @@ void Claw::open() {
 }
 
 void Claw::close() {
+    cancelCommand();
+    releaseGrip();
     // If the claw is closing, holding position is important in order to ensure
     // that the object being held is not let go of.
     motors.setBrakeMode(pros::E_MOTOR_BRAKE_HOLD);
@@ -60,37 +95,192 @@ void Claw::close() {
 }
 
 void Claw::openTo(double degrees) {
-    int timeout = 0;
+    waitForHoming();
+    openToAsync(degrees)->wait();
+}
+
+void Claw::closeTo(double degrees) {
+    waitForHoming();
+    closeToAsync(degrees)->wait();
+}
+
+// Overloaded openTo and closeTo functions that use digitalRotation
+void Claw::openTo() { openTo(digitalRotation); }
+void Claw::closeTo() { closeTo(digitalRotation); }
 
+bool Claw::closeUntilGripped() {
+    waitForHoming();
+    return closeUntilGrippedAsync()->wait();
+}
+
+std::shared_ptr<Completion> Claw::openToAsync(double degrees) {
+    commandMutex.take();
+    if (homing) {
+        commandMutex.give();
+        return refusedCommand();
+    }
+    std::shared_ptr<Completion> completion = startCommand(ClawCommand::move);
     // If the claw is opening, holding position is not important. So, it's
     // better to not have the motors hold position
     motors.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
     // The direction for the motors to rotate in order to open the claw is
     // assumed to be negative
+    commandTarget = motors.getPosition() - degrees;
     motors.moveRelative(-degrees, maxSpd);
-    while (!((motors.getPosition() > -degrees + 5) &&
-             (motors.getPosition() < -degrees - 5)) &&
-           timeout < 5) {
-        pros::delay(2);
-        ++timeout;
-    }
+    commandMutex.give();
+    return completion;
 }
 
-void Claw::closeTo(double degrees) {
-    int timeout = 0;
-
+std::shared_ptr<Completion> Claw::closeToAsync(double degrees) {
+    commandMutex.take();
+    if (homing) {
+        commandMutex.give();
+        return refusedCommand();
+    }
+    std::shared_ptr<Completion> completion = startCommand(ClawCommand::move);
     // If the claw is closing, holding position is important in order to ensure
     // that the object being held is not let go of.
     motors.setBrakeMode(pros::E_MOTOR_BRAKE_HOLD);
+    commandTarget = motors.getPosition() + degrees;
     motors.moveRelative(degrees, maxSpd);
-    while (!((motors.getPosition() < degrees + 5) &&
-             (motors.getPosition() > degrees - 5)) &&
-           timeout < 5) {
-        pros::delay(2);
-        ++timeout;
+    commandMutex.give();
+    return completion;
+}
+
+std::shared_ptr<Completion> Claw::openToAsync() {
+    return openToAsync(digitalRotation);
+}
+
+std::shared_ptr<Completion> Claw::closeToAsync() {
+    return closeToAsync(digitalRotation);
+}
+
+std::shared_ptr<Completion> Claw::closeUntilGrippedAsync() {
+    commandMutex.take();
+    if (homing) {
+        commandMutex.give();
+        return refusedCommand();
     }
+    std::shared_ptr<Completion> completion = startCommand(ClawCommand::grip);
+    motors.setBrakeMode(pros::E_MOTOR_BRAKE_HOLD);
+    motors.moveVelocity(maxSpd);
+    peakVelocity = 0;
+    commandMutex.give();
+    return completion;
 }
 
-// Overloaded openTo and closeTo functions that use digitalRotation
-void Claw::openTo() { openTo(digitalRotation); }
-void Claw::closeTo() { closeTo(digitalRotation); }
\ No newline at end of file
+bool Claw::isBusy() {
+    commandMutex.take();
+    bool busy = command != ClawCommand::none;
+    commandMutex.give();
+    return busy;
+}
+
+std::shared_ptr<Completion> Claw::startCommand(ClawCommand newCommand) {
+    startPeriodic();
+
+    // A new command replaces whatever the claw was doing
+    if (command != ClawCommand::none) commandCompletion->finish(false);
+    releaseGrip();
+
+    command = newCommand;
+    commandStart = pros::millis();
+    commandCompletion = std::make_shared<Completion>();
+    return commandCompletion;
+}
+
+std::shared_ptr<Completion> Claw::refusedCommand() {
+    std::shared_ptr<Completion> completion = std::make_shared<Completion>();
+    completion->finish(false);
+    return completion;
+}
+
+void Claw::waitForHoming() {
+    while (homing) pros::delay(10);
+}
+
+void Claw::cancelCommand() {
+    commandMutex.take();
+    if (command != ClawCommand::none) {
+        commandCompletion->finish(false);
+        command = ClawCommand::none;
+    }
+    commandMutex.give();
+}
+
+void Claw::periodic() { updateCommand(); }
+
+void Claw::updateCommand() {
+    commandMutex.take();
+    std::uint32_t elapsed = pros::millis() - commandStart;
+
+    if (command == ClawCommand::move) {
+        // Movements finish once they're within 5 degrees of the target, or
+        // after a second if the claw is blocked by something
+        if (fabs(motors.getPosition() - commandTarget) < 5) {
+            command = ClawCommand::none;
+            commandCompletion->finish(true);
+        } else if (elapsed > 1000) {
+            command = ClawCommand::none;
+            commandCompletion->finish(false);
+        }
+    } else if (command == ClawCommand::grip) {
+        double velocity = motors.getVelocity();
+        if (velocity > peakVelocity) peakVelocity = velocity;
+
+        /**
+         * Contact shows up as either a jump in current (the velocity
+         * controller pushing harder against the object) or the claw suddenly
+         * slowing down after getting up to speed. The first 50 ms are skipped,
+         * as the motors draw a lot of current while starting up.
+         */
+        bool slowed =
+            peakVelocity > maxSpd * 0.5 && velocity < peakVelocity * 0.3;
+        if (elapsed > 50 &&
+            (motors.getCurrentDraw() > contactCurrent || slowed)) {
+            // Keep squeezing, with the force limited by the current limit
+            motors.setCurrentLimit(gripCurrent);
+            motors.moveVoltage(12000);
+            gripping = true;
+            command = ClawCommand::none;
+            commandCompletion->finish(true);
+        } else if (elapsed > gripTimeout) {
+            motors.moveVelocity(0);
+            printf("Claw did not find an object to grip\n");
+            command = ClawCommand::none;
+            commandCompletion->finish(false);
+        }
+    }
+    commandMutex.give();
+}
+
+bool Claw::isGripping() { return gripping; }
+
+void Claw::releaseGrip() {
+    // Only one caller gets to restore the current limit
+    if (gripping.exchange(false)) motors.setCurrentLimit(2500);
+}
+
+bool Claw::home() {
+    // Set under the command mutex, so no command can start after this
+    commandMutex.take();
+    homing = true;
+    commandMutex.give();
+    cancelCommand();
+    releaseGrip();
+    motors.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
+    // Opening is the negative direction
+    homed = motors.homeToStop(-homingSpeed, homingCurrent, homingTimeout);
+    if (!homed) printf("Claw homing timed out\n");
+    homing = false;
+    return homed;
+}
+
+void Claw::homeAsync() {
+    if (homing.exchange(true)) return;
+    pros::Task([this] { home(); }, "Claw Homing");
+}
+
+bool Claw::isHomed() { return homed; }
+
+LatencyHistogram& Claw::getInputLatency() { return inputLatency; }
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "lib/Completion.hpp"
+
+#include "api.h"
+
+void Completion::finish(bool success) {
+    // succeeded is set first, so it is valid as soon as done is seen
+    succeeded = success;
+    done = true;
+}
+
+bool Completion::isDone() { return done; }
+
+bool Completion::wasSuccessful() { return done && succeeded; }
+
+bool Completion::wait(std::uint32_t timeout) {
+    std::uint32_t start = pros::millis();
+    while (!done && pros::millis() - start < timeout) pros::delay(5);
+    return wasSuccessful();
+}
@@ -0,0 +1,54 @@
+#include "lib/ControllerArbiter.hpp"
+
+#include <cstdlib>
+
+void ControllerArbiter::update() {
+    // Inputs bound on any of the snapshots are read from both controllers, as
+    // either controller can stand in for the other
+    std::uint8_t boundAxes = master.getBoundAxes() | partner.getBoundAxes() |
+                             shared.getBoundAxes();
+    std::uint16_t boundButtons = master.getBoundButtons() |
+                                 partner.getBoundButtons() |
+                                 shared.getBoundButtons();
+    master.bind(boundAxes, boundButtons);
+    partner.bind(boundAxes, boundButtons);
+
+    // Both controllers are read back to back, so neither input is older than
+    // the other
+    master.update();
+    partner.update();
+    combine();
+}
+
+void ControllerArbiter::combine() {
+    int axes[4];
+    for (int axis = 0; axis < 4; axis++) {
+        int masterValue = master.getAxes()[axis];
+        axes[axis] = (abs(masterValue) > deadband || !partner.isConnected())
+                         ? masterValue
+                         : partner.getAxes()[axis];
+    }
+    shared.set(axes, master.getButtons() | partner.getButtons(),
+               master.getTimestamp(),
+               master.isConnected() || partner.isConnected());
+}
+
+ControllerState& ControllerArbiter::getRaw(ControlSource source) {
+    return source == ControlSource::partner ? partner : master;
+}
+
+ControllerState& ControllerArbiter::get(ControlSource source) {
+    switch (source) {
+        case ControlSource::master:
+            if (!master.isConnected() && partner.isConnected()) return partner;
+            return master;
+        case ControlSource::partner:
+            if (!partner.isConnected()) return master;
+            return partner;
+        case ControlSource::shared:
+        default:
+            return shared;
+    }
+}
+
+void ControllerArbiter::setDeadband(int threshold) { deadband = threshold; }
\ No newline at end of file
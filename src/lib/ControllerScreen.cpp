@@ -0,0 +1,100 @@
+#include "lib/ControllerScreen.hpp"
+
+#include <cstring>
+
+ControllerScreen::ControllerScreen(pros::controller_id_e_t controller)
+    : controller{controller} {}
+
+void ControllerScreen::start() {
+    if (task != NULL) return;
+    task = new pros::Task(
+        [this] {
+            std::uint32_t time = pros::millis();
+            while (true) {
+                sendNext();
+                pros::Task::delay_until(&time, 50);
+            }
+        },
+        TASK_PRIORITY_DEFAULT - 1, TASK_STACK_DEPTH_DEFAULT,
+        "Controller Screen");
+}
+
+void ControllerScreen::post(int line, const char* text, int priority) {
+    if (line < 0 || line > 2) return;
+    char padded[16];
+    snprintf(padded, sizeof(padded), "%-15s", text);
+
+    mutex.take();
+    Line& target = lines[line];
+    // Duplicates of what is already shown or waiting are dropped
+    const char* current = target.dirty ? target.pending : target.shown;
+    if (strcmp(current, padded) != 0) {
+        if (strcmp(target.shown, padded) == 0) {
+            // Back to what is on the screen, so nothing needs sending
+            target.dirty = false;
+        } else {
+            strcpy(target.pending, padded);
+            target.dirty = true;
+            target.priority = priority;
+        }
+    }
+    mutex.give();
+}
+
+void ControllerScreen::rumble(const char* pattern, int priority) {
+    mutex.take();
+    if (!rumbleDirty || priority >= rumblePriority) {
+        snprintf(rumblePattern, sizeof(rumblePattern), "%s", pattern);
+        rumbleDirty = true;
+        rumblePriority = priority;
+    }
+    mutex.give();
+}
+
+void ControllerScreen::sendNext() {
+    /**
+     * The message is copied out and sent without holding the mutex, so
+     * posting never waits on the controller
+     */
+    mutex.take();
+    int best = -1;
+    int bestPriority = 0;
+    for (int line = 0; line < 3; line++) {
+        if (lines[line].dirty &&
+            (best == -1 || lines[line].priority > bestPriority)) {
+            best = line;
+            bestPriority = lines[line].priority;
+        }
+    }
+    bool sendRumble =
+        rumbleDirty && (best == -1 || rumblePriority >= bestPriority);
+    char message[16] = "";
+    if (sendRumble)
+        strcpy(message, rumblePattern);
+    else if (best != -1)
+        strcpy(message, lines[best].pending);
+    mutex.give();
+    if (!sendRumble && best == -1) return;
+
+    /**
+     * Only one message is sent per call, as the controller drops anything
+     * sent within 50 ms of the last message. If sending fails, the message
+     * stays queued and is tried again next time
+     */
+    if (sendRumble) {
+        if (pros::c::controller_rumble(controller, message) == PROS_ERR) return;
+        mutex.take();
+        // A new rumble may have been queued while this one was sent
+        if (strcmp(rumblePattern, message) == 0) rumbleDirty = false;
+        mutex.give();
+    } else {
+        if (pros::c::controller_set_text(controller, best, 0, message) ==
+            PROS_ERR)
+            return;
+        mutex.take();
+        Line& line = lines[best];
+        strcpy(line.shown, message);
+        if (strcmp(line.pending, message) == 0) line.dirty = false;
+        mutex.give();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "lib/ControllerState.hpp"
+
+ControllerState::ControllerState(pros::controller_id_e_t controller)
+    : controller{controller} {}
+
+void ControllerState::update() {
+    stamp(pros::micros());
+    connected = pros::c::controller_is_connected(controller);
+    // Only the bound inputs are read, as each read is a separate call into
+    // the controller API
+    for (int axis = 0; axis < 4; axis++) {
+        if (boundAxes & (1 << axis))
+            axes[axis] = pros::c::controller_get_analog(
+                controller, static_cast<pros::controller_analog_e_t>(axis));
+    }
+
+    prevButtons = buttons;
+    buttons = 0;
+    for (int button = pros::E_CONTROLLER_DIGITAL_L1;
+         button <= pros::E_CONTROLLER_DIGITAL_A; button++) {
+        auto id = static_cast<pros::controller_digital_e_t>(button);
+        if ((boundButtons & getButtonMask(id)) &&
+            pros::c::controller_get_digital(controller, id))
+            buttons |= getButtonMask(id);
+    }
+    // Buttons read for the first time have no previous reading, so they start
+    // out without an edge
+    prevButtons = (prevButtons & readButtons) | (buttons & ~readButtons);
+    readButtons = boundButtons;
+}
+
+void ControllerState::set(const int newAxes[4], std::uint16_t newButtons,
+                          std::uint64_t time, bool isConnected) {
+    stamp(time == 0 ? pros::micros() : time);
+    connected = isConnected;
+    for (int axis = 0; axis < 4; axis++) axes[axis] = newAxes[axis];
+    prevButtons = buttons;
+    buttons = newButtons;
+}
+
+void ControllerState::stamp(std::uint64_t time) {
+    if (timestamp != 0) sampleInterval.record(time - timestamp);
+    timestamp = time;
+}
+
+pros::controller_id_e_t ControllerState::getController() { return controller; }
+
+bool ControllerState::isConnected() { return connected; }
+
+void ControllerState::bind(std::uint8_t axes, std::uint16_t buttons) {
+    boundAxes |= axes;
+    boundButtons |= buttons;
+}
+
+std::uint8_t ControllerState::getBoundAxes() { return boundAxes; }
+
+std::uint16_t ControllerState::getBoundButtons() { return boundButtons; }
+
+int ControllerState::getAnalog(pros::controller_analog_e_t axis) {
+    boundAxes |= 1 << axis;
+    return axes[axis];
+}
+
+bool ControllerState::getDigital(pros::controller_digital_e_t button) {
+    boundButtons |= getButtonMask(button);
+    return buttons & getButtonMask(button);
+}
+
+bool ControllerState::getNewPress(pros::controller_digital_e_t button) {
+    boundButtons |= getButtonMask(button);
+    return (buttons & ~prevButtons) & getButtonMask(button);
+}
+
+bool ControllerState::getNewRelease(pros::controller_digital_e_t button) {
+    boundButtons |= getButtonMask(button);
+    return (~buttons & prevButtons) & getButtonMask(button);
+}
+
+const int* ControllerState::getAxes() { return axes; }
+
+std::uint16_t ControllerState::getButtons() { return buttons; }
+
+std::uint16_t ControllerState::getButtonMask(
+    pros::controller_digital_e_t button) {
+    return 1 << (button - pros::E_CONTROLLER_DIGITAL_L1);
+}
+
+std::uint64_t ControllerState::getTimestamp() { return timestamp; }
+
+LatencyHistogram& ControllerState::getSampleInterval() {
+    return sampleInterval;
+}
\ No newline at end of file
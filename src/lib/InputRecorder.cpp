@@ -0,0 +1,242 @@
+#include "lib/InputRecorder.hpp"
+
+#include <cstring>
+
+bool InputRecorder::startRecording(const char* path, std::uint32_t period) {
+    // The previous recording has to finish writing first
+    if (recording || file != NULL) return false;
+    if (!pros::c::usd_is_installed()) return false;
+    file = fopen(path, "wb");
+    if (file == NULL) return false;
+
+    head = 0;
+    tail = 0;
+    for (int i = 0; i < controllerCount; i++) {
+        for (int axis = 0; axis < 4; axis++) recordedAxes[i][axis] = 0;
+        recordedButtons[i] = 0;
+    }
+    skippedTicks = 0;
+    droppedTicks = 0;
+    tickPeriod = period;
+
+    std::uint8_t header[5] = {'V', 'I', 'R', '2',
+                              static_cast<std::uint8_t>(period)};
+    push(header, 5);
+    recording = true;
+
+    /**
+     * The writer task runs below the default priority, so writing to the SD
+     * card never holds up the control loop. Once recording stops, it writes
+     * whatever is left and closes the file
+     */
+    pros::Task(
+        [this] {
+            while (recording) {
+                writeBuffer();
+                pros::delay(50);
+            }
+            writeBuffer();
+            fclose(file);
+            file = NULL;
+        },
+        TASK_PRIORITY_DEFAULT - 1, TASK_STACK_DEPTH_DEFAULT, "Input Writer");
+    return true;
+}
+
+void InputRecorder::record(ControllerState& master, ControllerState& partner) {
+    if (!recording) return;
+
+    // Large enough for a gap and two frames with every input changed
+    std::uint8_t frame[32];
+    int length = 0;
+
+    // Ticks that didn't fit in the buffer are recorded as a gap first
+    if (skippedTicks > 0) {
+        frame[length++] = 0x20;
+        length += encodeVarint(skippedTicks, frame + length);
+    }
+    length += encodeFrame(master, 0, frame + length);
+    length += encodeFrame(partner, 1, frame + length);
+
+    /**
+     * Changes are only remembered once they make it into the buffer, so the
+     * next frame is always encoded against what was actually recorded
+     */
+    if (push(frame, length)) {
+        ControllerState* states[controllerCount] = {&master, &partner};
+        for (int i = 0; i < controllerCount; i++) {
+            for (int axis = 0; axis < 4; axis++)
+                recordedAxes[i][axis] = states[i]->getAxes()[axis];
+            recordedButtons[i] = states[i]->getButtons();
+        }
+        skippedTicks = 0;
+    } else {
+        skippedTicks++;
+        droppedTicks++;
+    }
+}
+
+int InputRecorder::encodeFrame(ControllerState& state, int index,
+                               std::uint8_t* out) {
+    int length = 1;
+    std::uint8_t flags = state.isConnected() ? 0 : 0x40;
+    const int* axes = state.getAxes();
+    for (int axis = 0; axis < 4; axis++) {
+        int delta = axes[axis] - recordedAxes[index][axis];
+        if (delta != 0) {
+            flags |= 1 << axis;
+            // Zigzag encoding keeps small negative changes small
+            std::uint32_t zigzag = delta >= 0 ? delta * 2 : -delta * 2 - 1;
+            length += encodeVarint(zigzag, out + length);
+        }
+    }
+    std::uint16_t buttons = state.getButtons();
+    if (buttons != recordedButtons[index]) {
+        flags |= 0x10;
+        out[length++] = buttons & 0xFF;
+        out[length++] = buttons >> 8;
+    }
+    out[0] = flags;
+    return length;
+}
+
+void InputRecorder::stopRecording() { recording = false; }
+
+bool InputRecorder::isRecording() { return recording; }
+
+std::uint32_t InputRecorder::getDroppedTicks() { return droppedTicks; }
+
+bool InputRecorder::push(const std::uint8_t* data, int length) {
+    int currentHead = head;
+    int used = (currentHead - tail + bufferSize) % bufferSize;
+    // One byte is always left free, so a full buffer isn't mistaken for an
+    // empty one
+    if (used + length >= bufferSize) return false;
+    for (int i = 0; i < length; i++)
+        buffer[(currentHead + i) % bufferSize] = data[i];
+    head = (currentHead + length) % bufferSize;
+    return true;
+}
+
+void InputRecorder::writeBuffer() {
+    int currentHead = head;
+    int currentTail = tail;
+    if (currentHead == currentTail) return;
+
+    if (currentHead > currentTail) {
+        fwrite(buffer + currentTail, 1, currentHead - currentTail, file);
+    } else {
+        // The data wraps around the end of the buffer
+        fwrite(buffer + currentTail, 1, bufferSize - currentTail, file);
+        fwrite(buffer, 1, currentHead, file);
+    }
+    tail = currentHead;
+    // Flushing keeps the recording intact if the program is stopped
+    fflush(file);
+}
+
+int InputRecorder::encodeVarint(std::uint32_t value, std::uint8_t* out) {
+    int length = 0;
+    while (value >= 0x80) {
+        out[length++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[length++] = value;
+    return length;
+}
+
+bool InputRecorder::readVarint(std::uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (playbackPos >= playbackData.size()) return false;
+        std::uint8_t byte = playbackData[playbackPos++];
+        value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool InputRecorder::startPlayback(const char* path) {
+    FILE* playbackFile = fopen(path, "rb");
+    if (playbackFile == NULL) {
+        printf("Couldn't open %s for playback\n", path);
+        return false;
+    }
+    playbackData.clear();
+    std::uint8_t chunk[256];
+    std::size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), playbackFile)) > 0)
+        playbackData.insert(playbackData.end(), chunk, chunk + read);
+    fclose(playbackFile);
+
+    if (playbackData.size() < 5 ||
+        memcmp(playbackData.data(), "VIR2", 4) != 0) {
+        printf("%s is not an input recording\n", path);
+        return false;
+    }
+    tickPeriod = playbackData[4];
+    playbackPos = 5;
+    for (int i = 0; i < controllerCount; i++) {
+        for (int axis = 0; axis < 4; axis++) playedAxes[i][axis] = 0;
+        playedButtons[i] = 0;
+        playedConnected[i] = true;
+    }
+    holdTicks = 0;
+    playing = true;
+    return true;
+}
+
+bool InputRecorder::play(ControllerState& master, ControllerState& partner) {
+    if (!playing) return false;
+
+    // Inside a gap, the inputs stay the same
+    if (holdTicks > 0) {
+        holdTicks--;
+    } else if (playbackPos >= playbackData.size()) {
+        playing = false;
+        return false;
+    } else if (playbackData[playbackPos] == 0x20) {
+        playbackPos++;
+        std::uint32_t ticks;
+        if (!readVarint(ticks) || ticks == 0) {
+            playing = false;
+            return false;
+        }
+        // This tick is the first of the gap
+        holdTicks = ticks - 1;
+    } else if (!readFrame(0) || !readFrame(1)) {
+        playing = false;
+        return false;
+    }
+
+    master.set(playedAxes[0], playedButtons[0], 0, playedConnected[0]);
+    partner.set(playedAxes[1], playedButtons[1], 0, playedConnected[1]);
+    return true;
+}
+
+bool InputRecorder::readFrame(int index) {
+    if (playbackPos >= playbackData.size()) return false;
+    std::uint8_t flags = playbackData[playbackPos++];
+
+    for (int axis = 0; axis < 4; axis++) {
+        if (flags & (1 << axis)) {
+            std::uint32_t zigzag;
+            if (!readVarint(zigzag)) return false;
+            int delta = (zigzag & 1) ? -static_cast<int>((zigzag + 1) / 2)
+                                     : static_cast<int>(zigzag / 2);
+            playedAxes[index][axis] += delta;
+        }
+    }
+    if (flags & 0x10) {
+        if (playbackPos + 2 > playbackData.size()) return false;
+        playedButtons[index] =
+            playbackData[playbackPos] | (playbackData[playbackPos + 1] << 8);
+        playbackPos += 2;
+    }
+    playedConnected[index] = !(flags & 0x40);
+    return true;
+}
+
+bool InputRecorder::isPlaying() { return playing; }
+
+std::uint32_t InputRecorder::getTickPeriod() { return tickPeriod; }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "lib/LatencyHistogram.hpp"
+
+const std::uint32_t LatencyHistogram::bucketLimits[bucketCount - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000};
+
+void LatencyHistogram::record(std::uint32_t latency) {
+    int bucket = 0;
+    while (bucket < bucketCount - 1 && latency > bucketLimits[bucket]) bucket++;
+    mutex.take();
+    counts[bucket]++;
+    samples++;
+    total += latency;
+    if (latency > maxLatency) maxLatency = latency;
+    mutex.give();
+}
+
+void LatencyHistogram::recordSince(std::uint64_t start) {
+    record(pros::micros() - start);
+}
+
+void LatencyHistogram::reset() {
+    mutex.take();
+    for (int bucket = 0; bucket < bucketCount; bucket++) counts[bucket] = 0;
+    samples = 0;
+    total = 0;
+    maxLatency = 0;
+    mutex.give();
+}
+
+std::uint32_t LatencyHistogram::getCount() {
+    mutex.take();
+    std::uint32_t count = samples;
+    mutex.give();
+    return count;
+}
+
+std::uint32_t LatencyHistogram::getAverage() {
+    mutex.take();
+    std::uint32_t average = samples == 0 ? 0 : total / samples;
+    mutex.give();
+    return average;
+}
+
+std::uint32_t LatencyHistogram::getMax() {
+    mutex.take();
+    std::uint32_t max = maxLatency;
+    mutex.give();
+    return max;
+}
+
+void LatencyHistogram::print(const char* name) {
+    // Printing is slow, so it works from a snapshot rather than holding the
+    // mutex (and the tasks recording latencies) the whole time
+    mutex.take();
+    std::uint32_t snapshot[bucketCount];
+    for (int bucket = 0; bucket < bucketCount; bucket++)
+        snapshot[bucket] = counts[bucket];
+    std::uint32_t count = samples;
+    std::uint32_t average = samples == 0 ? 0 : total / samples;
+    std::uint32_t max = maxLatency;
+    mutex.give();
+
+    printf("%s: %d samples, avg %d us, max %d us\n", name,
+           static_cast<int>(count), static_cast<int>(average),
+           static_cast<int>(max));
+    for (int bucket = 0; bucket < bucketCount; bucket++) {
+        if (bucket < bucketCount - 1)
+            printf("  <= %5d us: %d\n", static_cast<int>(bucketLimits[bucket]),
+                   static_cast<int>(snapshot[bucket]));
+        else
+            printf("   > %5d us: %d\n",
+                   static_cast<int>(bucketLimits[bucket - 1]),
+                   static_cast<int>(snapshot[bucket]));
+    }
+}
\ No newline at end of file
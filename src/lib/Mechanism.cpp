@@ -0,0 +1,24 @@
+#include "lib/Mechanism.hpp"
+
+Mechanism::Mechanism(const char* name, std::uint32_t period)
+    : name{name}, period{period} {}
+
+void Mechanism::setPeriod(std::uint32_t period) { this->period = period; }
+
+void Mechanism::startPeriodic() {
+    if (scheduled || periodicTask != NULL) return;
+    periodicTask = new pros::Task(
+        [this] {
+            std::uint32_t time = pros::millis();
+            // The task ends if a Scheduler takes over
+            while (!scheduled) {
+                periodic();
+                pros::Task::delay_until(&time, period);
+            }
+        },
+        name);
+}
+
+const char* Mechanism::getName() { return name; }
+
+std::uint32_t Mechanism::getPeriod() { return period; }
\ No newline at end of file
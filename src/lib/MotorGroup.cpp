@@ -51,6 +51,10 @@ void MotorGroup::setGearing(pros::motor_gearset_e_t gearing) {
     for (int p : motorPorts) pros::c::motor_set_gearing(p, gearing);
 }
 
+void MotorGroup::setCurrentLimit(int limit) {
+    for (int p : motorPorts) pros::c::motor_set_current_limit(p, limit);
+}
+
 /* Telemetry Functions */
 
 double MotorGroup::getPosition() {
@@ -59,6 +63,69 @@ double MotorGroup::getPosition() {
     return sum / motorPorts.size();
 }
 
+double MotorGroup::getVelocity() {
+    double sum = 0;
+    for (int p : motorPorts) sum += pros::c::motor_get_actual_velocity(p);
+    return sum / motorPorts.size();
+}
+
+int MotorGroup::getMaxVelocity() {
+    switch (pros::c::motor_get_gearing(motorPorts[0])) {
+        case pros::E_MOTOR_GEARSET_36:
+            return 100;
+        case pros::E_MOTOR_GEARSET_06:
+            return 600;
+        case pros::E_MOTOR_GEARSET_18:
+        default:
+            return 200;
+    }
+}
+
+double MotorGroup::getTemperature() {
+    double hottest = 0;
+    for (int p : motorPorts) {
+        double temperature = pros::c::motor_get_temperature(p);
+        if (temperature > hottest) hottest = temperature;
+    }
+    return hottest;
+}
+
+double MotorGroup::getCurrentDraw() {
+    double sum = 0;
+    for (int p : motorPorts) sum += pros::c::motor_get_current_draw(p);
+    return sum / motorPorts.size();
+}
+
+bool MotorGroup::isStalled(double currentThreshold, double velocityThreshold) {
+    return getCurrentDraw() > currentThreshold &&
+           fabs(getVelocity()) < velocityThreshold;
+}
+
 void MotorGroup::resetPosition() {
     for (int p : motorPorts) pros::c::motor_tare_position(p);
+}
+
+bool MotorGroup::homeToStop(int velocity, double currentThreshold,
+                            std::uint32_t timeout,
+                            const std::function<bool()>& cancel) {
+    moveVelocity(velocity);
+    // Give the motors time to get moving, so the current spike from starting
+    // up isn't mistaken for a stall
+    pros::delay(200);
+
+    std::uint32_t start = pros::millis();
+    int stalledCount = 0;
+    while (stalledCount < 5 && pros::millis() - start < timeout) {
+        if (cancel && cancel()) break;
+        if (isStalled(currentThreshold, 5))
+            ++stalledCount;
+        else
+            stalledCount = 0;
+        pros::delay(10);
+    }
+    moveVelocity(0);
+
+    if (stalledCount < 5) return false;
+    resetPosition();
+    return true;
 }
\ No newline at end of file
@@ -1,38 +1,223 @@
 #include "lib/PneumaticClaw.hpp"
 
+#include <cmath>
+
 PneumaticClaw::PneumaticClaw(char port, bool initPosition)
-    : p{port}, closed{initPosition} {
+    : Mechanism("PneumaticClaw", 2), p{port}, closed{initPosition} {
     pros::c::adi_port_set_config(p, pros::E_ADI_DIGITAL_OUT);
 }
 
-void PneumaticClaw::driver(pros::controller_id_e_t controller,
+void PneumaticClaw::setMinToggleInterval(std::uint32_t milliseconds) {
+    minToggleInterval = milliseconds;
+}
+
+void PneumaticClaw::setLatency(std::uint32_t closeMs, std::uint32_t openMs) {
+    closeLatency = closeMs;
+    openLatency = openMs;
+}
+
+bool PneumaticClaw::calibrateLatency(char switchPort) {
+    pros::c::adi_port_set_config(switchPort, pros::E_ADI_DIGITAL_IN);
+
+    // Start open, and give the claw time to get there
+    open();
+    pros::delay(500);
+
+    // Time the claw closing onto the switch, then opening off of it
+    std::uint32_t start = pros::millis();
+    close();
+    while (!pros::c::adi_digital_read(switchPort) &&
+           pros::millis() - start < 1000)
+        pros::delay(1);
+    std::uint32_t measuredClose = pros::millis() - start;
+
+    start = pros::millis();
+    open();
+    while (pros::c::adi_digital_read(switchPort) &&
+           pros::millis() - start < 1000)
+        pros::delay(1);
+    std::uint32_t measuredOpen = pros::millis() - start;
+
+    if (measuredClose >= 1000 || measuredOpen >= 1000) {
+        printf("Claw latency calibration failed\n");
+        return false;
+    }
+    setLatency(measuredClose, measuredOpen);
+    printf("Claw latency: close %d ms, open %d ms\n",
+           static_cast<int>(measuredClose), static_cast<int>(measuredOpen));
+    return true;
+}
+
+void PneumaticClaw::setCylinders(double bore, double stroke, int count) {
+    cylinderVolume = 3.1415 / 4 * bore * bore * stroke * count;
+}
+
+void PneumaticClaw::setAirSupply(double tankVolume, double startPressure,
+                                 double minPressure) {
+    this->tankVolume = tankVolume;
+    pressure = startPressure;
+    this->minPressure = minPressure;
+    warned = false;
+}
+
+void PneumaticClaw::setPressureSensor(char port, double maxPressure) {
+    sensorPort = port;
+    sensorMaxPressure = maxPressure;
+    pros::c::adi_port_set_config(port, pros::E_ADI_ANALOG_IN);
+}
+
+void PneumaticClaw::setAirReserve(int reserve, int warning) {
+    reserveActuations = reserve;
+    warningActuations = warning;
+}
+
+void PneumaticClaw::setScreen(ControllerScreen* controllerScreen,
+                              int line) {
+    screen = controllerScreen;
+    screenLine = line;
+    postState();
+}
+
+void PneumaticClaw::driver(ControllerState& controller,
                            pros::controller_digital_e_t button) {
     /**
-     * The driver function requires that the button to control the claw is held
-     * down for multiple cycles. This prevents the claw from opening on a button
-     * press, then immediately closing since the button is still pressed on the
+     * The claw toggles on a new press of the button, so holding the button
+     * down doesn't make the claw open and then immediately close again on the
      * next iteration of the opcontrol while loop.
      */
-    if (pros::c::controller_get_digital(controller, button)) ++pressedCount;
-    if (pressedCount >= 15) {
-        if (closed)
+    if (controller.getNewPress(button) &&
+        pros::millis() - lastToggleTime >= minToggleInterval) {
+        int remaining = getRemainingActuations();
+        bool wasClosed = closed;
+        if (!closed)
+            close();
+        else if (remaining < 0 || remaining > reserveActuations)
             open();
+        // Opening is refused once only the reserve is left
+        if (closed != wasClosed)
+            inputLatency.recordSince(controller.getTimestamp());
+        lastToggleTime = pros::millis();
+    }
+
+    // Warn the driver once when air starts running low
+    if (!warned && getRemainingActuations() >= 0 &&
+        getRemainingActuations() <= warningActuations) {
+        if (screen != NULL)
+            screen->rumble("---", 2);
         else
-            close();
-        pressedCount = 0;
+            pros::c::controller_rumble(controller.getController(), "---");
+        warned = true;
     }
 }
 
 void PneumaticClaw::close() {
+    // Acting now replaces anything that was scheduled
+    scheduleMutex.take();
+    scheduled = false;
+    scheduleMutex.give();
     if (!closed) {
         pros::c::adi_digital_write(p, true);
         closed = true;
+        useAir();
+        postState();
     }
 }
 
 void PneumaticClaw::open() {
+    scheduleMutex.take();
+    scheduled = false;
+    scheduleMutex.give();
     if (closed) {
         pros::c::adi_digital_write(p, false);
         closed = false;
+        useAir();
+        postState();
+    }
+}
+
+bool PneumaticClaw::isClosed() { return closed; }
+
+LatencyHistogram& PneumaticClaw::getInputLatency() { return inputLatency; }
+
+std::uint32_t PneumaticClaw::getCloseLatency() { return closeLatency; }
+
+std::uint32_t PneumaticClaw::getOpenLatency() { return openLatency; }
+
+double PneumaticClaw::getPressure() {
+    if (sensorPort == 0) return pressure;
+    /**
+     * The raw reading is used rather than adi_analog_read_calibrated, as
+     * calibrating would zero the sensor at whatever pressure the tanks were at
+     * when the program started. 0.5 V and 4.5 V read as 410 and 3686
+     */
+    double reading = pros::c::adi_analog_read(sensorPort);
+    return (reading - 410) / (3686 - 410) * sensorMaxPressure;
+}
+
+int PneumaticClaw::getRemainingActuations() {
+    if (tankVolume <= 0) return -1;
+    double current = getPressure();
+    if (current <= minPressure) return 0;
+    if (cylinderVolume <= 0 || minPressure <= 0) return -1;
+    /**
+     * Every actuation multiplies the gauge pressure by the same ratio, so the
+     * number of actuations until the minimum is a logarithm
+     */
+    double ratio = tankVolume / (tankVolume + cylinderVolume);
+    return static_cast<int>(log(minPressure / current) / log(ratio));
+}
+
+void PneumaticClaw::postState() {
+    if (screen == NULL) return;
+    char text[16];
+    int remaining = getRemainingActuations();
+    if (remaining >= 0)
+        snprintf(text, sizeof(text), "Claw %-6s %3d",
+                 closed ? "closed" : "open", remaining);
+    else
+        snprintf(text, sizeof(text), "Claw %s", closed ? "closed" : "open");
+    screen->post(screenLine, text, 1);
+}
+
+void PneumaticClaw::useAir() {
+    if (tankVolume <= 0) return;
+    pressure *= tankVolume / (tankVolume + cylinderVolume);
+}
+
+void PneumaticClaw::closeAt(std::uint32_t finishTime) {
+    schedule(true, finishTime);
+}
+
+void PneumaticClaw::openAt(std::uint32_t finishTime) {
+    schedule(false, finishTime);
+}
+
+void PneumaticClaw::schedule(bool close, std::uint32_t finishTime) {
+    startPeriodic();
+
+    scheduleMutex.take();
+    scheduledClose = close;
+    // Fire early by the latency of the movement
+    fireTime = finishTime - (close ? closeLatency : openLatency);
+    scheduled = true;
+    scheduleMutex.give();
+}
+
+void PneumaticClaw::periodic() { updateSchedule(); }
+
+void PneumaticClaw::updateSchedule() {
+    scheduleMutex.take();
+    // The difference is checked as a signed value so that a fire time that
+    // has already passed fires right away
+    bool fire = scheduled &&
+                static_cast<std::int32_t>(pros::millis() - fireTime) >= 0;
+    bool close = scheduledClose;
+    scheduleMutex.give();
+
+    if (fire) {
+        if (close)
+            this->close();
+        else
+            open();
     }
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "lib/PneumaticGroup.hpp"
+
+int PneumaticGroup::addSolenoid(char port, bool initState) {
+    return addSolenoid(INTERNAL_ADI_PORT, port, initState);
+}
+
+int PneumaticGroup::addSolenoid(std::uint8_t expanderPort, char port,
+                                bool initState) {
+    pros::c::ext_adi_port_set_config(expanderPort, port,
+                                     pros::E_ADI_DIGITAL_OUT);
+    pros::c::ext_adi_digital_write(expanderPort, port, initState);
+
+    mutex.take();
+    solenoids.push_back({expanderPort, port, initState, initState});
+    int id = solenoids.size() - 1;
+    mutex.give();
+    return id;
+}
+
+void PneumaticGroup::set(int id, bool state) {
+    mutex.take();
+    if (id >= 0 && id < static_cast<int>(solenoids.size()))
+        solenoids[id].state = state;
+    mutex.give();
+}
+
+void PneumaticGroup::toggle(int id) {
+    mutex.take();
+    if (id >= 0 && id < static_cast<int>(solenoids.size()))
+        solenoids[id].state = !solenoids[id].state;
+    mutex.give();
+}
+
+bool PneumaticGroup::get(int id) {
+    mutex.take();
+    bool state = id >= 0 && id < static_cast<int>(solenoids.size()) &&
+                 solenoids[id].state;
+    mutex.give();
+    return state;
+}
+
+void PneumaticGroup::update() {
+    mutex.take();
+    // Only solenoids that changed are written, so an update with nothing to
+    // do sends nothing over the smart ports
+    for (Solenoid& solenoid : solenoids) {
+        if (solenoid.state != solenoid.written) {
+            pros::c::ext_adi_digital_write(solenoid.smartPort,
+                                           solenoid.adiPort, solenoid.state);
+            solenoid.written = solenoid.state;
+        }
+    }
+    mutex.give();
+}
+
+void PneumaticGroup::startTask(std::uint32_t period) {
+    if (updateTask != NULL) return;
+    updateTask = new pros::Task(
+        [this, period] {
+            std::uint32_t time = pros::millis();
+            while (true) {
+                update();
+                pros::Task::delay_until(&time, period);
+            }
+        },
+        "PneumaticGroup Update");
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "lib/Scheduler.hpp"
+
+int Scheduler::add(Mechanism* mechanism, int priority) {
+    // Stops the mechanism's own task, if it started one
+    mechanism->scheduled = true;
+
+    mutex.take();
+    // Insert after every mechanism with the same or a higher priority, so
+    // mechanisms with equal priorities run in the order they were added
+    int id = entries.size();
+    auto it = entries.begin();
+    while (it != entries.end() && it->priority >= priority) ++it;
+    entries.insert(it, {id, mechanism, priority, pros::millis(), 0, {}});
+    mutex.give();
+    return id;
+}
+
+void Scheduler::start() {
+    if (task != NULL) return;
+    /**
+     * The scheduler runs above the default priority, so mechanism updates
+     * aren't delayed by the opcontrol and autonomous tasks
+     */
+    task = new pros::Task(
+        [this] {
+            std::uint32_t time = pros::millis();
+            while (true) {
+                tick();
+                pros::Task::delay_until(&time, 1);
+            }
+        },
+        TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, "Scheduler");
+}
+
+void Scheduler::tick() {
+    mutex.take();
+    for (Entry& entry : entries) {
+        std::uint32_t now = pros::millis();
+        if (static_cast<std::int32_t>(now - entry.nextRun) < 0) continue;
+
+        std::uint64_t start = pros::micros();
+        entry.mechanism->periodic();
+        std::uint32_t elapsed = pros::micros() - start;
+
+        entry.totalTime += elapsed;
+        entry.stats.runs++;
+        entry.stats.averageTime = entry.totalTime / entry.stats.runs;
+        if (elapsed > entry.stats.maxTime) entry.stats.maxTime = elapsed;
+
+        /**
+         * The next call is a period after this one was due, keeping the
+         * mechanism on its schedule. If it has fallen a whole period behind,
+         * it restarts from now rather than running several times to catch up
+         */
+        entry.nextRun += entry.mechanism->getPeriod();
+        if (static_cast<std::int32_t>(now - entry.nextRun) >= 0) {
+            entry.stats.overruns++;
+            entry.nextRun = now + entry.mechanism->getPeriod();
+        }
+    }
+    mutex.give();
+}
+
+MechanismStats Scheduler::getStats(int id) {
+    MechanismStats stats;
+    mutex.take();
+    for (Entry& entry : entries)
+        if (entry.id == id) stats = entry.stats;
+    mutex.give();
+    return stats;
+}
+
+void Scheduler::printStats() {
+    mutex.take();
+    for (Entry& entry : entries) {
+        printf("%s: %d runs, avg %d us, max %d us, %d overruns\n",
+               entry.mechanism->getName(),
+               static_cast<int>(entry.stats.runs),
+               static_cast<int>(entry.stats.averageTime),
+               static_cast<int>(entry.stats.maxTime),
+               static_cast<int>(entry.stats.overruns));
+    }
+    mutex.give();
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include "lib/StopConditions.hpp"
+
+#include "api.h"
+
+std::function<bool()> StopCondition::distanceBelow(std::uint8_t port,
+                                                   int millimeters) {
+    return [port, millimeters] {
+        int32_t distance = pros::c::distance_get(port);
+        // A disconnected sensor shouldn't stop the movement
+        return distance != PROS_ERR && distance < millimeters;
+    };
+}
+
+std::function<bool()> StopCondition::switchPressed(char port) {
+    pros::c::adi_port_set_config(port, pros::E_ADI_DIGITAL_IN);
+    return [port] { return pros::c::adi_digital_read(port) == 1; };
+}
+
+std::function<bool()> StopCondition::lineDetected(char port, int threshold) {
+    pros::c::adi_port_set_config(port, pros::E_ADI_ANALOG_IN);
+    return [port, threshold] {
+        int32_t reading = pros::c::adi_analog_read(port);
+        return reading != PROS_ERR && reading < threshold;
+    };
+}
@@ -2,7 +2,7 @@
 
 FourBar::FourBar(std::initializer_list<int> ports,
                  std::initializer_list<bool> revs)
-    : motors(ports, revs) {
+    : Mechanism("FourBar", 10), motors(ports, revs) {
     // Encoders output their rotation in degrees (Other options don't really
     // make sense)
     motors.setEncoderUnits(pros::E_MOTOR_ENCODER_DEGREES);
@@ -22,23 +22,159 @@ void FourBar::setMaxSpeeds(int maxUpRPM, int maxDownRPM) {
 
 void FourBar::setHoldThreshold(double degrees) { holdThreshold = degrees; }
 
+void FourBar::setPositionControl(double kP, double tolerance,
+                                 std::uint32_t period) {
+    kP_position = kP;
+    settleTolerance = tolerance;
+    setPeriod(period);
+}
+
+void FourBar::setHoldMode(HoldMode mode, double kP, int currentLimit,
+                          double disturbance) {
+    holdMode = mode;
+    kP_hold = kP;
+    holdCurrentLimit = currentLimit;
+    disturbanceThreshold = disturbance;
+}
+
+void FourBar::setHoming(int speed, double current, std::uint32_t timeout) {
+    homingSpeed = speed;
+    homingCurrent = current;
+    homingTimeout = timeout;
+}
+
+void FourBar::setPresetHeight(LiftPreset preset, double degrees) {
+    presetHeights[static_cast<int>(preset)] = degrees;
+}
+
+void FourBar::setGravityCompensation(double empty, double loaded,
+                                     double horizontal, PneumaticClaw* claw) {
+    kG = empty;
+    kG_loaded = loaded;
+    horizontalAngle = horizontal;
+    payloadClaw = claw;
+}
+
 // Movement Functions
-void FourBar::driver(pros::controller_id_e_t controller,
+void FourBar::driver(ControllerState& controller,
                      pros::controller_digital_e_t upButton,
                      pros::controller_digital_e_t downButton) {
-    if (pros::c::controller_get_digital(controller, upButton))
+    /**
+     * The driver can't move the lift until homing is done. Holding either
+     * button cancels homing though, so a blocked lift doesn't take away
+     * control of it for the whole homing timeout
+     */
+    if (homing) {
+        if (controller.getDigital(upButton) ||
+            controller.getDigital(downButton))
+            homingCancelled = true;
+        return;
+    }
+
+    if (controller.getDigital(upButton)) {
         up();
-    else if (pros::c::controller_get_digital(controller, downButton))
+        inputLatency.recordSince(controller.getTimestamp());
+    } else if (controller.getDigital(downButton)) {
         down();
-    else
+        inputLatency.recordSince(controller.getTimestamp());
+    }
+    // Leave the lift alone while the position controller is moving it
+    else if (isSettled())
         stop();
 }
 
-void FourBar::up() { motors.moveVelocity(maxUpSpd); }
+void FourBar::driver(ControllerState& controller,
+                     pros::controller_digital_e_t upButton,
+                     pros::controller_digital_e_t downButton,
+                     pros::controller_digital_e_t presetUpButton,
+                     pros::controller_digital_e_t presetDownButton) {
+    // Only the manual buttons do anything while homing
+    if (homing) {
+        driver(controller, upButton, downButton);
+        return;
+    }
 
-void FourBar::down() { motors.moveVelocity(-maxDownSpd); }
+    bool upPressed = controller.getDigital(upButton);
+    bool downPressed = controller.getDigital(downButton);
+
+    /**
+     * Holding a manual button always wins. Otherwise, a new press of a preset
+     * button cycles to the next preset. In manual control with no buttons
+     * pressed, the lift stops as usual, and while moving to a preset, the
+     * state changes once the controller has settled.
+     */
+    if (upPressed || downPressed) {
+        state = LiftState::manual;
+        driver(controller, upButton, downButton);
+    } else if (controller.getNewPress(presetUpButton) ||
+               controller.getNewPress(presetDownButton)) {
+        goToPreset(nextPreset(controller.getNewPress(presetUpButton)));
+        // periodic records the latency once it first moves the motors
+        controllerMutex.take();
+        presetInputTime = controller.getTimestamp();
+        controllerMutex.give();
+    } else if (state == LiftState::manual) {
+        stop();
+    } else if (state == LiftState::movingToPreset && isSettled()) {
+        state = LiftState::atPreset;
+    }
+}
+
+void FourBar::goToPreset(LiftPreset preset) {
+    if (!moveToAsync(presetHeights[static_cast<int>(preset)])) return;
+    currentPreset = preset;
+    state = LiftState::movingToPreset;
+}
+
+LiftPreset FourBar::nextPreset(bool up) {
+    int last = static_cast<int>(LiftPreset::max);
+    int index = static_cast<int>(currentPreset);
+
+    if (state == LiftState::manual) {
+        // Find the first preset past the lift's current height, ignoring
+        // presets within a few degrees of it
+        double angle = getAngle();
+        if (up) {
+            index = last;
+            for (int i = last; i >= 0; --i)
+                if (presetHeights[i] > angle + 3) index = i;
+        } else {
+            index = 0;
+            for (int i = 0; i <= last; ++i)
+                if (presetHeights[i] < angle - 3) index = i;
+        }
+    } else if (up && index < last) {
+        ++index;
+    } else if (!up && index > 0) {
+        --index;
+    }
+    return static_cast<LiftPreset>(index);
+}
+
+void FourBar::up() {
+    // Manual control overrides the position controller
+    controllerMutex.take();
+    positionControl = false;
+    release();
+    controllerMutex.give();
+    motors.moveVelocity(maxUpSpd);
+}
+
+void FourBar::down() {
+    controllerMutex.take();
+    positionControl = false;
+    release();
+    controllerMutex.give();
+    motors.moveVelocity(-maxDownSpd);
+}
 
 void FourBar::stop() {
+    controllerMutex.take();
+    rest();
+    controllerMutex.give();
+}
+
+void FourBar::rest() {
     /** If the motors current position is less than the holdThreshold *
      * extGearRatio, set the brake mode to coast. Otherwise, have the motors
      * hold position when they stop.
@@ -48,19 +184,229 @@ void FourBar::stop() {
      * extGearRatio represents the number of rotations done by the four bar lift
      * in one full rotation of the motor.
      */
-    if (motors.getPosition() <= (holdThreshold / extGearRatio))
+    if (motors.getPosition() <= (holdThreshold / extGearRatio)) {
+        release();
         motors.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
+        motors.moveVelocity(0);
+    } else if (holdMode == HoldMode::active) {
+        // periodic takes over holding the lift. stop() is called every cycle
+        // in driver control, so an existing hold is left alone
+        if (!holding) {
+            holding = true;
+            holdPosition = motors.getPosition();
+            disturbedCount = 0;
+            brakeCount = 0;
+            motors.setCurrentLimit(holdCurrentLimit);
+            startPeriodic();
+        }
+    } else {
+        motors.setBrakeMode(pros::E_MOTOR_BRAKE_HOLD);
+        motors.moveVelocity(0);
+    }
+}
+
+void FourBar::release() {
+    if (holding) {
+        holding = false;
+        motors.setCurrentLimit(2500);
+    }
+}
+
+bool FourBar::moveTo(double degrees, int speed, std::uint32_t timeout) {
+    while (homing) pros::delay(10);
+    if (!moveToAsync(degrees, speed)) return false;
+    return waitUntilSettled(timeout);
+}
+
+void FourBar::periodic() { updateController(); }
+
+bool FourBar::moveToAsync(double degrees, int speed) {
+    controllerMutex.take();
+    // The encoders are about to be zeroed while homing
+    if (homing) {
+        controllerMutex.give();
+        return false;
+    }
+    release();
+    // The target is converted from the lift's rotation to the motors' rotation
+    targetPosition = degrees / extGearRatio;
+    targetSpeed = speed;
+    settledCount = 0;
+    stalledCount = 0;
+    prevControlPosition = motors.getPosition();
+    reachedTarget = false;
+    positionControl = true;
+    controllerMutex.give();
+
+    startPeriodic();
+    return true;
+}
+
+bool FourBar::isSettled() {
+    controllerMutex.take();
+    bool settled = !positionControl;
+    controllerMutex.give();
+    return settled;
+}
+
+bool FourBar::waitUntilSettled(std::uint32_t timeout) {
+    std::uint32_t start = pros::millis();
+    while (!isSettled()) {
+        if (pros::millis() - start >= timeout) {
+            controllerMutex.take();
+            if (positionControl) {
+                positionControl = false;
+                rest();
+            }
+            controllerMutex.give();
+            break;
+        }
+        pros::delay(getPeriod());
+    }
+    controllerMutex.take();
+    bool settled = reachedTarget;
+    controllerMutex.give();
+    return settled;
+}
+
+void FourBar::updateController() {
+    controllerMutex.take();
+    if (!positionControl) {
+        if (holding) updateHold();
+        controllerMutex.give();
+        return;
+    }
+
+    double position = motors.getPosition();
+    double error = targetPosition - position;
+    if (fabs(error) <= settleTolerance)
+        ++settledCount;
+    else
+        settledCount = 0;
+    if (fabs(position - prevControlPosition) < 0.5)
+        ++stalledCount;
+    else
+        stalledCount = 0;
+    prevControlPosition = position;
+
+    if (settledCount >= 3) {
+        // Once settled, the lift holds (or rests) the same way it does after
+        // driver control
+        positionControl = false;
+        reachedTarget = true;
+        rest();
+    } else if (stalledCount >= 50) {
+        // The lift has stopped short of the target, so the movement gives up
+        // rather than pushing against whatever is in the way forever
+        printf("FourBar stalled %d degrees from its target\n",
+               static_cast<int>(error * extGearRatio));
+        positionControl = false;
+        rest();
+    } else {
+        int upSpeed = maxUpSpd, downSpeed = maxDownSpd;
+        if (targetSpeed > 0 && targetSpeed < upSpeed) upSpeed = targetSpeed;
+        if (targetSpeed > 0 && targetSpeed < downSpeed) downSpeed = targetSpeed;
+        double velocity = kP_position * error;
+        velocity = fmin(fmax(velocity, -downSpeed), upSpeed);
+
+        if (kG == 0 && kG_loaded == 0) {
+            motors.moveVelocity(velocity);
+        } else {
+            /**
+             * With gravity compensation, the motors are driven by voltage: the
+             * voltage that would reach the commanded velocity on a weightless
+             * lift, plus the voltage needed to hold the lift against gravity
+             */
+            double voltage = velocity * 12000 / motors.getMaxVelocity() +
+                             getGravityFeedforward();
+            motors.moveVoltage(fmin(fmax(voltage, -12000), 12000));
+        }
+        if (presetInputTime != 0) {
+            inputLatency.recordSince(presetInputTime);
+            presetInputTime = 0;
+        }
+    }
+    controllerMutex.give();
+}
+
+void FourBar::updateHold() {
+    double error = holdPosition - motors.getPosition();
+
+    // Brake hold fallback - once it runs out, actively hold wherever the
+    // disturbance left the lift
+    if (brakeCount > 0) {
+        if (--brakeCount == 0) {
+            holdPosition = motors.getPosition();
+            disturbedCount = 0;
+            motors.setCurrentLimit(holdCurrentLimit);
+        }
+        return;
+    }
+
+    if (fabs(error) > disturbanceThreshold)
+        ++disturbedCount;
     else
+        disturbedCount = 0;
+
+    if (disturbedCount >= 5) {
+        /**
+         * Something is pushing the lift harder than the reduced current can
+         * resist, so fall back to the motors' own brake hold at full current
+         * for half a second
+         */
+        brakeCount = 500 / getPeriod();
+        motors.setCurrentLimit(2500);
         motors.setBrakeMode(pros::E_MOTOR_BRAKE_HOLD);
-    motors.moveVelocity(0);
-};
-
-void FourBar::moveTo(double degrees, int speed) {
-    int velocity = speed;
-    if (degrees < motors.getPosition()) velocity *= -1;
-    degrees /= extGearRatio;
-    while (motors.getPosition() > degrees + 5 ||
-           motors.getPosition() < degrees - 5)
-        motors.moveVelocity(velocity);
-    stop();
-}
\ No newline at end of file
+        motors.moveVelocity(0);
+        return;
+    }
+
+    /**
+     * Gravity feedforward does most of the work of holding the lift up, with a
+     * small position correction for anything it doesn't account for. The
+     * reduced current limit keeps the motors from heating up fighting small
+     * errors.
+     */
+    double voltage = getGravityFeedforward() + kP_hold * error;
+    motors.moveVoltage(fmin(fmax(voltage, -12000), 12000));
+}
+
+double FourBar::getGravityFeedforward() {
+    bool loaded = payloadClaw != NULL && payloadClaw->isClosed();
+    double angle = (getAngle() - horizontalAngle) * 3.1415 / 180;
+    return (loaded ? kG_loaded : kG) * cos(angle);
+}
+
+// Telemetry Functions
+double FourBar::getAngle() { return motors.getPosition() * extGearRatio; }
+
+bool FourBar::home() {
+    controllerMutex.take();
+    homing = true;
+    homingCancelled = false;
+    positionControl = false;
+    release();
+    controllerMutex.give();
+
+    motors.setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
+    homed = motors.homeToStop(-homingSpeed, homingCurrent, homingTimeout,
+                              [this] { return homingCancelled.load(); });
+    if (!homed) printf("FourBar homing timed out or was cancelled\n");
+    homing = false;
+    return homed;
+}
+
+void FourBar::homeAsync() {
+    if (homing.exchange(true)) return;
+    pros::Task([this] { home(); }, "FourBar Homing");
+}
+
+double FourBar::getTemperature() { return motors.getTemperature(); }
+
+bool FourBar::isHomed() { return homed; }
+
+LiftState FourBar::getState() { return state; }
+
+LiftPreset FourBar::getPreset() { return currentPreset; }
+
+LatencyHistogram& FourBar::getInputLatency() { return inputLatency; }
\ No newline at end of file
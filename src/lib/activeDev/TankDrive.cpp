@@ -4,7 +4,9 @@ TankDrive::TankDrive(std::initializer_list<int> leftPorts,
                      std::initializer_list<int> rightPorts,
                      std::initializer_list<bool> leftRevs,
                      std::initializer_list<bool> rightRevs)
-    : leftMotors(leftPorts, leftRevs), rightMotors(rightPorts, rightRevs) {
+    : Mechanism("TankDrive", 10),
+      leftMotors(leftPorts, leftRevs),
+      rightMotors(rightPorts, rightRevs) {
     leftMotors.setEncoderUnits(pros::E_MOTOR_ENCODER_DEGREES);
     rightMotors.setEncoderUnits(pros::E_MOTOR_ENCODER_DEGREES);
 }
@@ -16,18 +18,44 @@ void TankDrive::setGearing(pros::motor_gearset_e_t gearing) {
 }
 
 void TankDrive::setPIDConstants(double Pconst, double Iconst, double Dconst) {
-    kP_straight = Pconst;
-    kI_straight = Iconst;
-    kD_straight = Dconst;
+    setPayloadPIDConstants(Payload::empty, Pconst, Iconst, Dconst);
+    setPayloadPIDConstants(Payload::goal, Pconst, Iconst, Dconst);
 }
 
 void TankDrive::setPIDTurnConstants(double Pconst, double Iconst,
                                     double Dconst) {
-    kP_turn = Pconst;
-    kI_turn = Iconst;
-    kD_turn = Dconst;
+    setPayloadPIDTurnConstants(Payload::empty, Pconst, Iconst, Dconst);
+    setPayloadPIDTurnConstants(Payload::goal, Pconst, Iconst, Dconst);
 }
 
+void TankDrive::setPayloadPIDConstants(Payload load, double Pconst,
+                                       double Iconst, double Dconst) {
+    PIDConstants& constants = straightConstants[static_cast<int>(load)];
+    constants.kP = Pconst;
+    constants.kI = Iconst;
+    constants.kD = Dconst;
+}
+
+void TankDrive::setPayloadPIDTurnConstants(Payload load, double Pconst,
+                                           double Iconst, double Dconst) {
+    PIDConstants& constants = turnConstants[static_cast<int>(load)];
+    constants.kP = Pconst;
+    constants.kI = Iconst;
+    constants.kD = Dconst;
+}
+
+void TankDrive::setPayloadFeedforward(Payload load, double staticVoltage) {
+    kS[static_cast<int>(load)] = staticVoltage;
+}
+
+void TankDrive::setPayloadDetection(PneumaticClaw* claw,
+                                    double accelThreshold) {
+    payloadClaw = claw;
+    payloadAccelThreshold = accelThreshold;
+}
+
+void TankDrive::setPayload(Payload load) { payload = load; }
+
 void TankDrive::setDimensions(double wheelDiameter, double wheelTrackWidth) {
     wheelRadius = wheelDiameter / 2;
     trackWidth = wheelTrackWidth / 2;
@@ -51,30 +79,213 @@ void TankDrive::addADIEncoders(char leftEncoderTopPort, bool leftEncoderRev,
         rightEncoderRev);
 }
 
+void TankDrive::setSlipDetection(double driveWheelDiameter, double gearRatio,
+                                 double threshold, std::uint32_t window) {
+    driveWheelRadius = driveWheelDiameter / 2;
+    driveGearRatio = gearRatio;
+    slipThreshold = threshold;
+    slipWindow = window;
+    resetSlipWindow();
+}
+
+void TankDrive::setAccelLimits(double accelStep, double decelStep) {
+    maxAccelStep = accelStep;
+    maxDecelStep = decelStep;
+}
+
+void TankDrive::setTipModel(FourBar* fourBar, double heightDown,
+                            double heightUp, double range) {
+    lift = fourBar;
+    comHeightDown = heightDown;
+    comHeightUp = heightUp;
+    liftRange = range;
+}
+
+void TankDrive::setScreen(ControllerScreen* controllerScreen, int line) {
+    screen = controllerScreen;
+    screenLine = line;
+}
+
+void TankDrive::setVisionAssist(std::uint8_t port, std::uint8_t signature,
+                                double kP, int maxTurn) {
+    visionPort = port;
+    visionSignature = signature;
+    visionKP = kP;
+    visionMaxTurn = maxTurn;
+    pros::c::vision_set_zero_point(port, pros::E_VISION_ZERO_CENTER);
+}
+
+void TankDrive::setDriverSlewRate(double maxChangePerMs) {
+    driverSlewRate = maxChangePerMs;
+}
+
+void TankDrive::setTractionControl(bool enabled, double maxAccel,
+                                   int headroom) {
+    tractionControl = enabled;
+    maxWheelAccel = maxAccel;
+    tractionHeadroom = headroom;
+}
+
 // Movement Functions
-void TankDrive::driver(pros::controller_id_e_t controller) {
-    leftMotors.move(pros::c::controller_get_analog(
-        controller, pros::E_CONTROLLER_ANALOG_LEFT_Y));
-    rightMotors.move(pros::c::controller_get_analog(
-        controller, pros::E_CONTROLLER_ANALOG_RIGHT_Y));
+void TankDrive::driver(ControllerState& controller) {
+    driveSides(controller,
+               controller.getAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y),
+               controller.getAnalog(pros::E_CONTROLLER_ANALOG_RIGHT_Y));
+}
+
+void TankDrive::driver(ControllerState& controller,
+                       pros::controller_digital_e_t assistButton) {
+    if (visionPort == 0 || !controller.getDigital(assistButton)) {
+        driver(controller);
+        return;
+    }
+
+    int leftY = controller.getAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
+    int rightY = controller.getAnalog(pros::E_CONTROLLER_ANALOG_RIGHT_Y);
+    int forward = (leftY + rightY) / 2;
+    int turn = getVisionTurn();
+    driveSides(controller, fmax(fmin(forward + turn, 127), -127),
+               fmax(fmin(forward - turn, 127), -127));
+}
+
+int TankDrive::getVisionTurn() {
+    std::uint32_t now = pros::millis();
+    if (!visionRead || now - lastVisionRead >= 20) {
+        // Objects are sorted by size, so the first is the largest (usually
+        // the nearest) goal
+        pros::vision_object_s_t goal =
+            pros::c::vision_get_by_sig(visionPort, 0, visionSignature);
+        visionTarget = goal.signature != VISION_OBJECT_ERR_SIG;
+        visionOffset = goal.x_middle_coord;
+        visionRead = true;
+        lastVisionRead = now;
+    }
+    if (!visionTarget) return 0;
+
+    double turn = visionKP * visionOffset;
+    return fmax(fmin(turn, visionMaxTurn), -visionMaxTurn);
+}
+
+void TankDrive::driveSides(ControllerState& controller, int left, int right) {
+    std::uint32_t now = pros::millis();
+    std::uint32_t dt = now - prevDriverTime;
+    prevDriverTime = now;
+    updateSlip();
+
+    leftMotors.move(limitDriverOutput(left, leftDriverOutput, leftPrevVelocity,
+                                      leftMotors, dt, leftSlipping));
+    rightMotors.move(limitDriverOutput(right, rightDriverOutput,
+                                       rightPrevVelocity, rightMotors, dt,
+                                       rightSlipping));
+    inputLatency.recordSince(controller.getTimestamp());
+
+    if (screen != NULL && now - lastScreenPost >= 1000) {
+        double temperature = leftMotors.getTemperature();
+        if (rightMotors.getTemperature() > temperature)
+            temperature = rightMotors.getTemperature();
+        bool hot = temperature >= 55;
+        char text[16];
+        snprintf(text, sizeof(text), "Drive %dC%s",
+                 static_cast<int>(temperature), hot ? " HOT" : "");
+        screen->post(screenLine, text, hot ? 2 : 0);
+        lastScreenPost = now;
+    }
+}
+
+int TankDrive::limitDriverOutput(int input, int& prevOutput,
+                                 double& prevVelocity, MotorGroup& motors,
+                                 std::uint32_t dt, bool slipping) {
+    int output = input;
+
+    /**
+     * Slew rate limiting - the output can only move driverSlewRate per
+     * millisecond since the last cycle away from the previous output, so the
+     * ramp doesn't depend on the loop period. dt is capped so a cycle after a
+     * long pause can't jump straight to full power. The rate shrinks as the
+     * lift goes up
+     */
+    double slewRate = 0;
+    if (driverSlewRate > 0) {
+        slewRate = fmax(driverSlewRate * getTipScale() * fmin(dt, 20), 1);
+        if (output > prevOutput + slewRate)
+            output = prevOutput + slewRate;
+        else if (output < prevOutput - slewRate)
+            output = prevOutput - slewRate;
+    }
+
+    double velocity = motors.getVelocity();
+    /**
+     * Traction control - if the wheels are speeding up faster than they could
+     * while gripping the field, they are spinning out. Rather than keep
+     * pushing more power into wheels that are slipping, the output is clamped
+     * to just above the power needed to hold the wheels' current speed, which
+     * lets them regain grip. dt is checked so that the first cycle (or a cycle
+     * after a long pause) doesn't produce a bogus acceleration.
+     *
+     * The wheels are allowed to accelerate as fast as slew rate limiting
+     * ramps the output (converted to RPM per second), if that is faster than
+     * maxWheelAccel, so that the commanded ramp never trips the clamp by
+     * itself. Only speeding up in the direction of the output counts: wheels
+     * still turning the other way are slowing down, not spinning out.
+     *
+     * Slip found by comparing the tracking wheels to the motor encoders is
+     * handled the same way. The clamped output never drops below
+     * tractionHeadroom in the output's direction, so it can't push the robot
+     * against the driver.
+     */
+    if (tractionControl && dt > 0 && dt < 100 && output != 0) {
+        double accel = (velocity - prevVelocity) * 1000.0 / dt;
+        double commandedAccel =
+            slewRate * motors.getMaxVelocity() / 127 * 1000.0 / dt;
+        bool spinning = velocity * output > 0 &&
+                        fabs(accel) > fmax(maxWheelAccel, commandedAccel) &&
+                        std::signbit(accel) == std::signbit(output);
+        if (slipping || spinning) {
+            // The wheels' speed in the direction of the output, from 0 to 127
+            double speed = fmax(copysign(1, output) * velocity, 0) /
+                           motors.getMaxVelocity() * 127;
+            int gripOutput = speed + tractionHeadroom;
+            if (abs(output) > gripOutput)
+                output = copysign(gripOutput, output);
+        }
+    }
+
+    prevVelocity = velocity;
+    prevOutput = output;
+    return output;
 }
 
-void TankDrive::drivePID(double leftTarg, double rightTarg, double kP,
-                         double kI, double kD) {
+bool TankDrive::drivePID(double leftTarg, double rightTarg, bool turning,
+                         const std::function<bool()>& until,
+                         const std::function<void()>& onTrigger,
+                         double leadTime,
+                         const std::function<void()>& onLead) {
     // Counts the number of cycles the robot has not moved - used for timeout
     // condition
     short int stoppedCount = 0;
     double leftTarg_Deg = (leftTarg / wheelRadius) * (180 / 3.1415);
     double rightTarg_Deg = (rightTarg / wheelRadius) * (180 / 3.1415);
-    // Reset the encoders of  each side
-    resetPositions();
+    /**
+     * Record the starting position of each side. The encoders are not reset,
+     * as odometry relies on them being continuous across movements
+     */
+    double leftStart = getLeftPosition();
+    double rightStart = getRightPosition();
+    startMovement();
 
     // Declare or initialize all variables used in the PID controller loop
-    double leftError = leftTarg_Deg - getLeftPosition();
-    double rightError = rightTarg_Deg - getRightPosition();
+    double leftError = leftTarg_Deg - (getLeftPosition() - leftStart);
+    double rightError = rightTarg_Deg - (getRightPosition() - rightStart);
     double leftOutput;
     double rightOutput;
+    double leftPrevOutput = 0;
+    double rightPrevOutput = 0;
     double voltCap = 0.0;
+    bool triggered = false;
+    // How quickly the drive is closing on its target, in degrees per
+    // millisecond, and whether the lead action has run
+    double closingSpeed = 0;
+    bool leadDone = false;
 
     // Integral variables are initiated so that the += operator can be used
     // throughout the while loop
@@ -90,6 +301,12 @@ void TankDrive::drivePID(double leftTarg, double rightTarg, double kP,
     while ((abs(leftError) > 5 || abs(rightError) > 5) && stoppedCount < 5) {
         printf("Left Targ: %f, Left Error: %f\n", leftTarg_Deg, leftError);
         printf("Right Targ: %f, Right Error: %f\n", rightTarg_Deg, rightError);
+        // End the movement early if the stop condition has been met
+        if (until && until()) {
+            triggered = true;
+            break;
+        }
+
         // Calculate the integral
         leftIntegral += leftError;
         rightIntegral += rightError;
@@ -102,52 +319,214 @@ void TankDrive::drivePID(double leftTarg, double rightTarg, double kP,
         leftPrevError = leftError;
         rightPrevError = rightError;
 
-        // Set the output values
-        leftOutput =
-            (leftError * kP) + (leftIntegral * kI) + (leftDerivative * kD);
-        rightOutput =
-            (rightError * kP) + (rightIntegral * kI) + (rightDerivative * kD);
+        // Get the constants for the current payload - it can change partway
+        // through the movement once the payload has been estimated
+        int load = static_cast<int>(payload);
+        PIDConstants k =
+            turning ? turnConstants[load] : straightConstants[load];
+
+        // Set the output values, including the static feedforward
+        leftOutput = (leftError * k.kP) + (leftIntegral * k.kI) +
+                     (leftDerivative * k.kD) + copysign(kS[load], leftError);
+        rightOutput = (rightError * k.kP) + (rightIntegral * k.kI) +
+                      (rightDerivative * k.kD) + copysign(kS[load], rightError);
 
         // Voltage slewing - prevents motors from recieving 12 volts from the
         // start
-        if (voltCap < 12000)
-            voltCap += 600;
-        else
-            voltCap = 12000;
+        voltCap = rampVoltCap(voltCap);
 
         if (abs(leftOutput) > voltCap)
             leftOutput = copysign(voltCap, leftOutput);
         if (abs(rightOutput) > voltCap)
             rightOutput = copysign(voltCap, rightOutput);
+
+        // Deceleration limiting - prevents the drive from stopping harder than
+        // it can without tipping
+        leftOutput = limitDecel(leftOutput, leftPrevOutput);
+        rightOutput = limitDecel(rightOutput, rightPrevOutput);
         printf("Left Output: %f Right Output: %f\n", leftOutput, rightOutput);
 
         // Set the motor group voltages to the output velocity levels
         leftMotors.moveVoltage(leftOutput);
         rightMotors.moveVoltage(rightOutput);
+        estimatePayload(leftOutput, rightOutput);
 
         // Calculate the new error
-        leftError = leftTarg_Deg - getLeftPosition();
-        rightError = rightTarg_Deg - getRightPosition();
+        leftError = leftTarg_Deg - (getLeftPosition() - leftStart);
+        rightError = rightTarg_Deg - (getRightPosition() - rightStart);
+
+        /**
+         * Lead action - the closing speed is filtered, as the change in error
+         * over one cycle is only a few encoder ticks. Once the remaining
+         * distance would be covered within leadTime at that speed, the action
+         * runs
+         */
+        if (onLead && !leadDone) {
+            double remaining = (fabs(leftError) + fabs(rightError)) / 2;
+            double progress =
+                (fabs(leftPrevError) + fabs(rightPrevError)) / 2 - remaining;
+            closingSpeed = 0.8 * closingSpeed + 0.2 * (progress / 5);
+            if (closingSpeed > 0 && remaining / closingSpeed <= leadTime) {
+                onLead();
+                leadDone = true;
+            }
+        }
 
-        // Timeout condition in case the drive gets stuck - rather not get to
-        // correct position and continue than stop entirely
+        /**
+         * Timeout condition in case the drive gets stuck - rather not get to
+         * correct position and continue than stop entirely. The drive is
+         * stuck if the encoders don't move while it pushes with at least the
+         * slip backoff floor. This doesn't depend on the cap, as the cap is
+         * held at that floor while pushing into a wall
+         */
         if (leftError == leftPrevError && rightError == rightPrevError &&
-            voltCap >= 6000)
+            fmax(fabs(leftOutput), fabs(rightOutput)) >= fmax(kS[load], 3000))
             stoppedCount++;
         else
             stoppedCount = 0;
         pros::delay(5);
     }
+    // The lead action always runs, even if the prediction never caught it
+    if (onLead && !leadDone) onLead();
+    if (triggered) {
+        /**
+         * The trigger action happens right away (so the claw grabs on
+         * contact), and the drive then slows down smoothly rather than
+         * slamming to a stop
+         */
+        if (onTrigger) onTrigger();
+        rampDown(leftPrevOutput, rightPrevOutput);
+        printf("Movement ended by stop condition\n");
+    }
     leftMotors.moveVelocity(0);
     rightMotors.moveVelocity(0);
     pros::delay(20);
+    return triggered;
+}
+
+void TankDrive::startMovement() {
+    if (payloadClaw != NULL)
+        payload = payloadClaw->isClosed() ? Payload::goal : Payload::empty;
+
+    // Slips from before the movement don't back off its voltage cap
+    voltCapSlipCount = slipCount;
+
+    estimateCycles = 0;
+    estimateVoltSum = 0;
+    estimateStartVelocity = (fabs(leftMotors.getVelocity()) +
+                             fabs(rightMotors.getVelocity())) /
+                            2;
+}
+
+void TankDrive::estimatePayload(double leftOutput, double rightOutput) {
+    if (payloadAccelThreshold <= 0 || estimateCycles > 20) return;
+
+    if (estimateCycles < 20) {
+        estimateVoltSum += (fabs(leftOutput) + fabs(rightOutput)) / 2;
+        ++estimateCycles;
+        return;
+    }
+    ++estimateCycles;
+
+    /**
+     * After 20 cycles (100 ms), compare the change in speed with the average
+     * voltage sent. A heavier robot gains less speed for the same voltage.
+     * The speeds of both sides are taken as magnitudes so that turns are
+     * measured the same way as straight movements.
+     */
+    double velocity =
+        (fabs(leftMotors.getVelocity()) + fabs(rightMotors.getVelocity())) / 2;
+    double accel = (velocity - estimateStartVelocity) / 0.1;
+    double avgVolts = estimateVoltSum / 20 / 1000;
+    // Too little voltage to tell anything (e.g. a very short movement)
+    if (avgVolts < 1) return;
+
+    lastAccelPerVolt = accel / avgVolts;
+    payload = (lastAccelPerVolt < payloadAccelThreshold) ? Payload::goal
+                                                         : Payload::empty;
+}
+
+double TankDrive::rampVoltCap(double voltCap) {
+    /**
+     * If the wheels are slipping, the cap is backed off instead so that the
+     * drive stays at the edge of traction. The slipping flags hold for a whole
+     * detection window, so the cap is only backed off once per new detection
+     * (when slipCount goes up), and held for the rest of the window. Early in
+     * a movement the cap is already below the floor, and isn't raised to it
+     */
+    updateSlip();
+    if (slipCount != voltCapSlipCount) {
+        voltCapSlipCount = slipCount;
+        return fmin(voltCap, fmax(voltCap - 2 * maxAccelStep, 3000));
+    }
+    if (isSlipping()) return voltCap;
+    // As in limitDecel, the step has a floor so the cap always rises, even
+    // if setAccelLimits was given a step of zero
+    double step = fmax(maxAccelStep * getTipScale(), 100);
+    if (voltCap < 12000) return fmin(voltCap + step, 12000);
+    return 12000;
+}
+
+double TankDrive::limitDecel(double output, double& prevOutput) {
+    // As in rampDown, the step has a floor so the drive can always slow down
+    double step = fmax(maxDecelStep * getTipScale(), 100);
+    // Only slowing down (or reversing) is limited here - speeding up is
+    // already limited by the voltage cap
+    if (fabs(output) < fabs(prevOutput) ||
+        std::signbit(output) != std::signbit(prevOutput)) {
+        if (output < prevOutput - step)
+            output = prevOutput - step;
+        else if (output > prevOutput + step)
+            output = prevOutput + step;
+    }
+    prevOutput = output;
+    return output;
+}
+
+void TankDrive::rampDown(double leftOutput, double rightOutput) {
+    // The step never drops below 100 mV, so a decel step (or tip scale) of 0
+    // can't stop the drive from ever reaching 0
+    double step = fmax(fmin(maxDecelStep, 1200) * getTipScale(), 100);
+    while (leftOutput != 0 || rightOutput != 0) {
+        // Move each output towards 0 by step, without overshooting past 0
+        leftOutput = copysign(fmax(fabs(leftOutput) - step, 0), leftOutput);
+        rightOutput = copysign(fmax(fabs(rightOutput) - step, 0), rightOutput);
+        leftMotors.moveVoltage(leftOutput);
+        rightMotors.moveVoltage(rightOutput);
+        pros::delay(5);
+    }
+}
+
+double TankDrive::getTipScale() {
+    if (lift == NULL) return 1;
+
+    // Fraction of the way the lift is through its range, kept between 0 and 1
+    double fraction = fmin(fmax(lift->getAngle() / liftRange, 0), 1);
+    double comHeight = comHeightDown + (comHeightUp - comHeightDown) * fraction;
+    /**
+     * The acceleration that tips the robot is inversely proportional to the
+     * height of its center of mass, so the limits are scaled by how much
+     * higher the center of mass is than with the lift down
+     */
+    return fmin(comHeightDown / comHeight, 1);
 }
 
 void TankDrive::moveStraight(double distance) {
     /**
      * moveStraight simply calls drivePID with both sides having the same target
      */
-    drivePID(distance, distance, kP_straight, kI_straight, kD_straight);
+    drivePID(distance, distance, false);
+}
+
+void TankDrive::moveStraight(double distance, double leadTime,
+                             const std::function<void()>& action) {
+    drivePID(distance, distance, false, nullptr, nullptr, leadTime, action);
+}
+
+bool TankDrive::moveStraightUntil(double maxDistance,
+                                  const std::function<bool()>& condition,
+                                  const std::function<void()>& onTrigger) {
+    return drivePID(maxDistance, maxDistance, false, condition, onTrigger);
 }
 
 void TankDrive::turnAngle(double angle) {
@@ -165,39 +544,228 @@ void TankDrive::turnAngle(double angle) {
      * Calling the drivePID. The right side gets -turnLength as that causes the
      * robot to turn clockwise (right) when a positive angle is entered
      */
-    drivePID(turnLength, -turnLength, kP_turn, kI_turn, kD_turn);
+    drivePID(turnLength, -turnLength, true);
 }
 
-// Telemetry Functions
-double TankDrive::getLeftPosition() {
-    double output = 0;
+void TankDrive::driveToPoint(double x, double y, std::uint32_t timeout) {
+    if (!odometryRunning) startOdometry();
+
+    double radToDeg = 180 / 3.1415;
+    short int stoppedCount = 0;
+    double voltCap = 0.0;
+
+    double leftPrevOutput = 0, rightPrevOutput = 0;
+    double linearIntegral = 0, turnIntegral = 0;
+    double linearPrevError = 0, turnPrevError = 0;
+    bool firstCycle = true;
+    Pose current = getPose();
+    double distance = hypot(x - current.x, y - current.y);
+    startMovement();
+    std::uint32_t start = pros::millis();
+
+    // Runs until the robot is within an inch of the point, or out of time
+    while (distance > 1 && stoppedCount < 5 &&
+           pros::millis() - start < timeout) {
+        current = getPose();
+        distance = hypot(x - current.x, y - current.y);
+
+        /**
+         * The heading to the point is measured clockwise from the +y axis,
+         * matching the pose. If the point is behind the robot, it backs up to
+         * it rather than turning all the way around.
+         */
+        double headingError = wrapAngle(
+            atan2(x - current.x, y - current.y) * radToDeg - current.theta);
+        double direction = 1;
+        if (fabs(headingError) > 90) {
+            direction = -1;
+            headingError = wrapAngle(headingError + 180);
+        }
+
+        /**
+         * Both errors are converted into degrees of wheel rotation, the same
+         * units drivePID uses, so the same PID constants apply. The distance
+         * error is scaled by how well the robot is facing the point, so it
+         * turns toward the point before driving hard at it. Close to the
+         * point, the heading to it swings wildly, so heading correction is
+         * dropped for the last few inches.
+         */
+        double linearError = direction * (distance / wheelRadius) * radToDeg *
+                             cos(headingError / radToDeg);
+        double turnError = 0;
+        if (distance > 3)
+            turnError = (headingError / radToDeg) * trackWidth / wheelRadius *
+                        radToDeg;
+
+        // Seeding the previous errors on the first cycle avoids a derivative
+        // kick from the whole error appearing at once
+        if (firstCycle) {
+            linearPrevError = linearError;
+            turnPrevError = turnError;
+            firstCycle = false;
+        }
+
+        linearIntegral += linearError;
+        turnIntegral += turnError;
+        double linearDerivative = linearError - linearPrevError;
+        double turnDerivative = turnError - turnPrevError;
+
+        int load = static_cast<int>(payload);
+        PIDConstants& straight = straightConstants[load];
+        PIDConstants& turn = turnConstants[load];
+        double linearOutput = (linearError * straight.kP) +
+                              (linearIntegral * straight.kI) +
+                              (linearDerivative * straight.kD);
+        double turnOutput = (turnError * turn.kP) + (turnIntegral * turn.kI) +
+                            (turnDerivative * turn.kD);
+        double leftOutput = linearOutput + turnOutput;
+        double rightOutput = linearOutput - turnOutput;
+        leftOutput += copysign(kS[load], leftOutput);
+        rightOutput += copysign(kS[load], rightOutput);
+
+        // Scale both sides down together so the ratio between them (and so
+        // the curvature of the path) is kept when capping the voltage
+        voltCap = rampVoltCap(voltCap);
+        double largest = fmax(fabs(leftOutput), fabs(rightOutput));
+        if (largest > voltCap) {
+            leftOutput *= voltCap / largest;
+            rightOutput *= voltCap / largest;
+        }
+        leftOutput = limitDecel(leftOutput, leftPrevOutput);
+        rightOutput = limitDecel(rightOutput, rightPrevOutput);
+
+        leftMotors.moveVoltage(leftOutput);
+        rightMotors.moveVoltage(rightOutput);
+        estimatePayload(leftOutput, rightOutput);
+
+        /**
+         * Timeout condition in case the drive gets stuck, the same as in
+         * drivePID. Both errors have to stop changing, as while pivoting
+         * toward a point off to the side, only the heading error changes
+         */
+        if (fabs(linearError - linearPrevError) < 0.5 &&
+            fabs(turnError - turnPrevError) < 0.5 &&
+            fmax(fabs(leftOutput), fabs(rightOutput)) >= fmax(kS[load], 3000))
+            stoppedCount++;
+        else
+            stoppedCount = 0;
+        linearPrevError = linearError;
+        turnPrevError = turnError;
+        pros::delay(5);
+    }
+    leftMotors.moveVelocity(0);
+    rightMotors.moveVelocity(0);
+    pros::delay(20);
+}
+
+void TankDrive::turnToHeading(double heading) {
+    if (!odometryRunning) startOdometry();
     /**
-     * If the drivetrain has ADI encoders, use them for the position. If not,
-     * use the internal motor encoders
+     * The turn is relative to the maintained heading rather than to wherever
+     * the last movement ended, so error from earlier movements is corrected
      */
-    if (leftEncoder != NULL)
-        output = leftEncoder->get_value();
-    else
-        output = leftMotors.getPosition();
+    turnAngle(wrapAngle(heading - getPose().theta));
+}
+
+// Odometry Functions
+void TankDrive::startOdometry() {
+    if (odometryRunning) return;
+    odomMutex.take();
+    odomPrevLeft = readLeftPosition();
+    odomPrevRight = readRightPosition();
+    odometryRunning = true;
+    odomMutex.give();
+    startPeriodic();
+}
+
+void TankDrive::periodic() {
+    if (odometryRunning) updateOdometry();
+}
+
+void TankDrive::updateOdometry() {
+    odomMutex.take();
+    double left = readLeftPosition();
+    double right = readRightPosition();
+
+    // Distance travelled by each side since the last update, in inches
+    double degToRad = 3.1415 / 180;
+    double leftDist = (left - odomPrevLeft) * degToRad * wheelRadius;
+    double rightDist = (right - odomPrevRight) * degToRad * wheelRadius;
+    odomPrevLeft = left;
+    odomPrevRight = right;
+
+    /**
+     * The change in heading comes from the difference between the sides
+     * (trackWidth is half the distance between them). The robot is assumed to
+     * have moved along its average heading over the update.
+     */
+    double headingChange = (leftDist - rightDist) / (2 * trackWidth);
+    double avgHeading = pose.theta * degToRad + headingChange / 2;
+    double distance = (leftDist + rightDist) / 2;
+    pose.x += distance * sin(avgHeading);
+    pose.y += distance * cos(avgHeading);
+    pose.theta = wrapAngle(pose.theta + headingChange / degToRad);
+    odomMutex.give();
+}
+
+void TankDrive::setPose(double x, double y, double theta) {
+    odomMutex.take();
+    pose.x = x;
+    pose.y = y;
+    pose.theta = wrapAngle(theta);
+    odomMutex.give();
+}
+
+Payload TankDrive::getPayload() { return payload; }
+
+double TankDrive::getAccelPerVolt() { return lastAccelPerVolt; }
+
+LatencyHistogram& TankDrive::getInputLatency() { return inputLatency; }
+
+Pose TankDrive::getPose() {
+    odomMutex.take();
+    Pose output = pose;
+    odomMutex.give();
+    return output;
+}
+
+double TankDrive::wrapAngle(double angle) {
+    angle = fmod(angle + 180, 360);
+    if (angle < 0) angle += 360;
+    return angle - 180;
+}
+
+// Telemetry Functions
+double TankDrive::getLeftPosition() {
+    double output = readLeftPosition();
     printf("Left Encoder Value: %.3lf\n", output);
     return output;
 }
 
 double TankDrive::getRightPosition() {
-    double output = 0;
+    double output = readRightPosition();
+    printf("Right Encoder Value: %.3lf\n", output);
+    return output;
+}
+
+double TankDrive::readLeftPosition() {
     /**
      * If the drivetrain has ADI encoders, use them for the position. If not,
      * use the internal motor encoders
      */
-    if (rightEncoder != NULL)
-        output = rightEncoder->get_value();
-    else
-        output = rightMotors.getPosition();
-    printf("Right Encoder Value: %.3lf\n", output);
-    return output;
+    if (leftEncoder != NULL) return leftEncoder->get_value();
+    return leftMotors.getPosition();
+}
+
+double TankDrive::readRightPosition() {
+    if (rightEncoder != NULL) return rightEncoder->get_value();
+    return rightMotors.getPosition();
 }
 
 void TankDrive::resetPositions() {
+    // Odometry is held off while the sensors are reset, so it doesn't see the
+    // reset as movement
+    odomMutex.take();
     if (leftEncoder != NULL)
         leftEncoder->reset();
     else
@@ -208,5 +776,72 @@ void TankDrive::resetPositions() {
     else
         rightMotors.resetPosition();
 
+    odomPrevLeft = readLeftPosition();
+    odomPrevRight = readRightPosition();
+    odomMutex.give();
+
+    resetSlipWindow();
     printf("Encoders have been reset.\n");
+}
+
+void TankDrive::updateSlip() {
+    if (slipThreshold <= 0 || leftEncoder == NULL || rightEncoder == NULL)
+        return;
+    if (pros::millis() - slipWindowStart < slipWindow) return;
+
+    double leftMotor = leftMotors.getPosition();
+    double rightMotor = rightMotors.getPosition();
+    double leftTrack = leftEncoder->get_value();
+    double rightTrack = rightEncoder->get_value();
+
+    /**
+     * Converting each source into inches travelled over the window. The motor
+     * encoders go through the external gear ratio onto the powered wheels,
+     * while the tracking wheels are read directly (wheelRadius is the
+     * tracking wheel radius when ADI encoders are used)
+     */
+    double degToRad = 3.1415 / 180;
+    double leftSlip =
+        (leftMotor - leftMotorStart) * driveGearRatio * degToRad *
+            driveWheelRadius -
+        (leftTrack - leftTrackStart) * degToRad * wheelRadius;
+    double rightSlip =
+        (rightMotor - rightMotorStart) * driveGearRatio * degToRad *
+            driveWheelRadius -
+        (rightTrack - rightTrackStart) * degToRad * wheelRadius;
+
+    leftSlipping = fabs(leftSlip) > slipThreshold;
+    rightSlipping = fabs(rightSlip) > slipThreshold;
+    if (leftSlipping || rightSlipping) {
+        ++slipCount;
+        lastSlip = fmax(fabs(leftSlip), fabs(rightSlip));
+    }
+
+    leftMotorStart = leftMotor;
+    rightMotorStart = rightMotor;
+    leftTrackStart = leftTrack;
+    rightTrackStart = rightTrack;
+    slipWindowStart = pros::millis();
+}
+
+void TankDrive::resetSlipWindow() {
+    leftMotorStart = leftMotors.getPosition();
+    rightMotorStart = rightMotors.getPosition();
+    if (leftEncoder != NULL) leftTrackStart = leftEncoder->get_value();
+    if (rightEncoder != NULL) rightTrackStart = rightEncoder->get_value();
+    slipWindowStart = pros::millis();
+    leftSlipping = false;
+    rightSlipping = false;
+}
+
+int TankDrive::getSlipCount() { return slipCount; }
+
+double TankDrive::getLastSlip() { return lastSlip; }
+
+bool TankDrive::isSlipping() { return leftSlipping || rightSlipping; }
+
+void TankDrive::resetSlipCount() {
+    slipCount = 0;
+    voltCapSlipCount = 0;
+    lastSlip = 0;
 }
\ No newline at end of file
@@ -1,5 +1,60 @@
 #include "main.h"
 
+#include <atomic>
+
+/**
+ * Which controller runs each subsystem. The master drives, while the lift and
+ * claw are shared, so a partner can run them without taking them away from
+ * the master. Subsystems mapped to a controller that disconnects fall back to
+ * the other one.
+ */
+const ControlSource driveSource = ControlSource::master;
+const ControlSource liftSource = ControlSource::shared;
+const ControlSource clawSource = ControlSource::shared;
+
+void driverControl(ControllerArbiter& inputs) {
+    drive.driver(inputs.get(driveSource), DIGITAL_L2);
+    lift.driver(inputs.get(liftSource), DIGITAL_R1, DIGITAL_R2, DIGITAL_X,
+                DIGITAL_B);
+
+    claw.driver(inputs.get(clawSource), DIGITAL_L1);
+}
+
+// The opcontrol loop period, in milliseconds. Matches the motors' 10 ms update
+const std::uint32_t loopPeriod = 10;
+
+/**
+ * Opcontrol loop timing: the time each tick's work took, and the number of
+ * ticks that ran past the loop period. Written by opcontrol, and read by the
+ * telemetry task
+ */
+LatencyHistogram loopTime;
+std::atomic<std::uint32_t> loopOverruns{0};
+
+void telemetry() {
+    std::uint32_t time = pros::millis();
+    while (true) {
+        pros::Task::delay_until(&time, 10000);
+        if (pros::competition::is_connected()) continue;
+
+        /**
+         * The input latency of every subsystem, along with the time between
+         * controller snapshots (the opcontrol loop period), which adds to all
+         * of them
+         */
+        controllers.get(ControlSource::master).getSampleInterval().print(
+            "Controller sample interval");
+        drive.getInputLatency().print("Drive input latency");
+        lift.getInputLatency().print("Lift input latency");
+        claw.getInputLatency().print("Claw input latency");
+
+        loopTime.print("Opcontrol loop time");
+        printf("Opcontrol overruns: %d\n",
+               static_cast<int>(loopOverruns.load()));
+        scheduler.printStats();
+    }
+}
+
 /**
  * Runs the operator control code. This function will be started in its own task
  * with the default priority and stack size whenever the robot is enabled via
@@ -14,12 +69,55 @@
  * task, not resume it from where it left off.
  */
 void opcontrol() {
+    // Find the lift's zero position in the background, if autonomous didn't.
+    // Driver control of the lift starts once it is done, or right away if the
+    // driver holds a lift button, which cancels it
+    if (!lift.isHomed()) lift.homeAsync();
+
+    /**
+     * Practice runs (when not connected to a field or competition switch) are
+     * recorded to the first unused /usd/run<N>.bin, for turning into a replay
+     * autonomous or reproducing a problem. Existing recordings are never
+     * overwritten, so nothing is recorded once all 100 are used
+     */
+    if (!pros::competition::is_connected()) {
+        char path[32];
+        bool found = false;
+        for (int run = 0; run < 100 && !found; run++) {
+            snprintf(path, sizeof(path), "/usd/run%d.bin", run);
+            FILE* existing = fopen(path, "r");
+            if (existing == NULL)
+                found = true;
+            else
+                fclose(existing);
+        }
+        if (!found)
+            printf("All 100 recording slots are used, not recording\n");
+        else if (recorder.startRecording(path, loopPeriod))
+            printf("Recording to %s\n", path);
+    }
+
+    /**
+     * The loop runs at a fixed rate: each tick starts loopPeriod after the
+     * last one started, however long the work took. A tick that runs past the
+     * period is counted as an overrun, and the next one starts straight away,
+     * so the number of ticks (and of recorded frames) keeps up with the clock
+     */
+    std::uint32_t time = pros::millis();
     while (true) {
-        drive.driver(CONTROLLER_MASTER);
-        lift.driver(CONTROLLER_MASTER, DIGITAL_R1, DIGITAL_R2);
+        std::uint64_t tickStart = pros::micros();
+
+        // Read the controllers once, so every subsystem sees the same inputs
+        controllers.update();
+        // Recordings hold both controllers, so replay arbitrates them the
+        // same way
+        recorder.record(controllers.getRaw(ControlSource::master),
+                        controllers.getRaw(ControlSource::partner));
 
-        claw.driver(CONTROLLER_MASTER, DIGITAL_L1);
+        driverControl(controllers);
 
-        pros::delay(20);
+        loopTime.recordSince(tickStart);
+        if (pros::millis() - time > loopPeriod) loopOverruns++;
+        pros::Task::delay_until(&time, loopPeriod);
     }
 }